@@ -0,0 +1,126 @@
+#include "EventLog.h"
+
+EventLog::EventLog() : fifo(queueSize) {
+  writer->addLog(this);
+}
+
+EventLog::~EventLog() {
+  writer->removeLog(this);
+}
+
+// AUDIO THREAD ***************************************************************
+
+void EventLog::write(int code, int64 time, const uint8_t *data, int dataSize) {
+  int start1, size1, start2, size2;
+  fifo.prepareToWrite(1, start1, size1, start2, size2);
+  if (size1 < 1) {
+    ++dropped;
+    return;
+  }
+  if (dataSize < 0) dataSize = 0;
+  LogRecord &record = records[start1];
+  record.code = code;
+  record.time = time;
+  record.size = dataSize;
+  if (dataSize > LOG_PAYLOAD_SIZE) dataSize = LOG_PAYLOAD_SIZE;
+  if (dataSize > 0) memcpy(record.payload, data, dataSize);
+  fifo.finishedWrite(1);
+}
+
+// BACKGROUND THREAD **********************************************************
+
+EventLogWriter::EventLogWriter() : Thread("stangin log") {
+  file = File::getSpecialLocation(File::userApplicationDataDirectory)
+    .getChildFile("stangin").getChildFile("stangin.log");
+  startThread(0);
+}
+
+EventLogWriter::~EventLogWriter() {
+  stopThread(1000);
+}
+
+void EventLogWriter::addLog(EventLog *log) {
+  const ScopedLock sl(lock);
+  log->instance = nextInstance++;
+  logs.add(log);
+}
+
+void EventLogWriter::removeLog(EventLog *log) {
+  const ScopedLock sl(lock);
+  // write out anything the log still holds before it goes away
+  String text;
+  flushLog(log, text);
+  writeText(text);
+  logs.removeFirstMatchingValue(log);
+}
+
+void EventLogWriter::run() {
+  while (! threadShouldExit()) {
+    wait(250);
+    flush();
+  }
+  flush();
+}
+
+void EventLogWriter::flush() {
+  const ScopedLock sl(lock);
+  String text;
+  for (int i = 0; i < logs.size(); i++) flushLog(logs[i], text);
+  writeText(text);
+}
+
+void EventLogWriter::flushLog(EventLog *log, String &text) {
+  int i, start1, size1, start2, size2;
+  log->fifo.prepareToRead(EventLog::queueSize, start1, size1, start2, size2);
+  for (i = 0; i < size1; i++) text += format(log->records[start1 + i], log->instance);
+  for (i = 0; i < size2; i++) text += format(log->records[start2 + i], log->instance);
+  log->fifo.finishedRead(size1 + size2);
+  // report records dropped since the last flush
+  int droppedTotal = log->dropped.get();
+  if (droppedTotal != log->droppedReported) {
+    text += String::formatted("%s instance %d dropped %d records (%d total)\n", 
+      Time::getCurrentTime().toString(true, true).toRawUTF8(), log->instance, 
+      droppedTotal - log->droppedReported, droppedTotal);
+    log->droppedReported = droppedTotal;
+  }
+}
+
+void EventLogWriter::writeText(const String &text) {
+  if (text.isEmpty()) return;
+  // open the log file on demand so no file is made unless there's a problem
+  if (stream == nullptr) {
+    file.getParentDirectory().createDirectory();
+    stream = new FileOutputStream(file);
+    if (stream->failedToOpen()) {
+      stream = nullptr;
+      return;
+    }
+  }
+  stream->writeText(text, false, false);
+  stream->flush();
+}
+
+String EventLogWriter::format(const LogRecord &record, int instance) {
+  int stored = jmin(record.size, LOG_PAYLOAD_SIZE);
+  String prefix = String::formatted("%s instance %d sample %lld: ", 
+    Time::getCurrentTime().toString(true, true).toRawUTF8(), instance, 
+    (long long)record.time);
+  String payload = String::toHexString(record.payload, stored);
+  if (record.size > stored) payload += " ...";
+  switch (record.code) {
+    case LogUnhandledSysex:
+      return(prefix + "UNHANDLED SYSEX: " + payload + "\n");
+    case LogShortSysex:
+      return(prefix + "SHORT SYSEX: " + payload + "\n");
+    case LogQueueOverflow:
+      return(prefix + "QUEUE OVERFLOW: " + payload + "\n");
+    case LogOversizeMessage:
+      return(prefix + String::formatted("OVERSIZE MESSAGE (%d bytes): ", record.size) + 
+             payload + "\n");
+    case LogNoteOutOfRange:
+      if (stored < 3) break;
+      return(prefix + String::formatted("NOTE OUT OF RANGE: string %d, note %d\n", 
+        record.payload[0] + 1, (int)(int16)(record.payload[1] | (record.payload[2] << 8))));
+  }
+  return(prefix + String::formatted("EVENT %d: ", record.code) + payload + "\n");
+}
@@ -0,0 +1,85 @@
+#ifndef EVENTLOG_H_INCLUDED
+#define EVENTLOG_H_INCLUDED
+
+#include "JuceHeader.h"
+
+// codes for logged events
+typedef enum {
+  LogUnhandledSysex = 1, // a sysex message the engine doesn't understand
+  LogShortSysex, // a sysex message too short to decode
+  LogNoteOutOfRange, // a note outside the MIDI range was dropped
+  LogQueueOverflow, // a message was dropped because too many were being held
+  LogOversizeMessage // a message was dropped because it was longer than any the controller sends
+} LogCode;
+
+// the maximum number of payload bytes stored with a record
+#define LOG_PAYLOAD_SIZE 16
+
+// a fixed-size log record that can be written without allocating
+typedef struct {
+  int code; // the kind of event (see LogCode)
+  int64 time; // the absolute sample time of the event
+  int size; // the size of the original payload, which may have been truncated
+  uint8_t payload[LOG_PAYLOAD_SIZE]; // the first bytes of the payload
+} LogRecord;
+
+class EventLog;
+
+// formats records from every log in the process into a single file, so 
+//  instances don't write over each other (use with SharedResourcePointer)
+class EventLogWriter : public Thread {
+  public:
+    EventLogWriter();
+    ~EventLogWriter();
+    
+    // start or stop writing records from a log
+    void addLog(EventLog *log);
+    void removeLog(EventLog *log);
+    
+    void run() override;
+
+  protected:
+    File file; // the file to append formatted records to
+    ScopedPointer<FileOutputStream> stream; // opened on the first record
+    CriticalSection lock; // guards the list of logs and the file
+    Array<EventLog *> logs;
+    int nextInstance = 1;
+    
+    // format and write all queued records
+    void flush();
+    void flushLog(EventLog *log, String &text);
+    void writeText(const String &text);
+    String format(const LogRecord &record, int instance);
+
+  private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventLogWriter)
+};
+
+// a log that can be written from the audio thread, with records queued 
+//  for a background thread shared by all instances to write to a file
+class EventLog {
+  public:
+    EventLog();
+    ~EventLog();
+    
+    // queue a record, dropping it if the queue is full
+    void write(int code, int64 time, const uint8_t *data, int dataSize);
+    
+    // the number of records dropped because the queue was full
+    Atomic<int> dropped;
+
+  protected:
+    friend class EventLogWriter;
+    static const int queueSize = 256;
+    AbstractFifo fifo;
+    LogRecord records[queueSize];
+    int droppedReported = 0; // the dropped count last written to the file
+    int instance = 0; // a number that tags this log's records in the file
+    
+    SharedResourcePointer<EventLogWriter> writer;
+
+  private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventLog)
+};
+
+#endif  // EVENTLOG_H_INCLUDED
@@ -5,15 +5,13 @@ StanginAudioProcessorEditor::StanginAudioProcessorEditor (StanginAudioProcessor&
                             : AudioProcessorEditor (&p), processor (p) {
   // configure sizes
   em = 18;
-  setSize(21 * em, 18 * em);
+  setSize(21 * em, 35 * em);
   // configure graphics
   font = Font((float)em, Font::FontStyleFlags::bold);
   smallFont = font.withHeight((float)((em * 2) / 3));
   bg = Colour::greyLevel(0.1);
   fg = Colour::greyLevel(1.0);
   accent = Colour::fromHSV(0.0, 1.0, 0.75, 1.0);
-  // set up the menu of tunings
-  initTuningMenu();
   // start updating the display
   startTimerHz(20);
 }
@@ -23,6 +21,7 @@ StanginAudioProcessorEditor::~StanginAudioProcessorEditor() {
 }
 
 void StanginAudioProcessorEditor::timerCallback() {
+  updateTablature();
   repaint();
 }
 
@@ -32,18 +31,53 @@ void StanginAudioProcessorEditor::paint (Graphics& g) {
   drawStrings(g);
   // draw the menu button for tunings
   drawTuningMenu(g);
-  // draw sliders
+  // draw controls and the velocity curve
+  drawSliders(g);
+  drawButtons(g);
+  drawCurve(g);
+  // draw the history of played notes
+  drawTablature(g);
+}
+
+// draw all sliders with labels showing their values
+void StanginAudioProcessorEditor::drawSliders(Graphics &g) {
   int detune = processor.guitar.detune;
   String detuneText = String::formatted("DETUNE: %s%d", 
                                         detune > 0 ? "+" : "", detune);
   drawSlider(g, detuneArea, detuneText, getDetuneFraction(), detuneActive);
   String sustainText = String::formatted("SUSTAIN: %.01f", processor.guitar.sustain);
   drawSlider(g, sustainArea, sustainText, getSustainFraction(), sustainActive);
-  // draw buttons
+  String reconcileText = String::formatted("PICK/FRET WINDOW: %.0f MS", 
+                                           processor.guitar.reconcileWindow * 1000.0);
+  drawSlider(g, reconcileArea, reconcileText, getReconcileFraction(), reconcileActive);
+}
+
+// draw all buttons with labels showing their settings
+void StanginAudioProcessorEditor::drawButtons(Graphics &g) {
   drawButton(g, hammeronArea, String("HAMMER ON"), processor.guitar.hammeron);
   drawButton(g, pulloffArea, String("PULL OFF"), processor.guitar.pulloff);
   drawButton(g, dampOpenArea, String("DAMP OPEN"), processor.guitar.dampOpen);
   drawButton(g, tapArea, String("TAP"), processor.guitar.tap);
+  drawButton(g, mergeArea, String("MERGE MIDI"), 
+             processor.guitar.passthrough != 0);
+  int channel = processor.guitar.passthroughChannel;
+  String remapText = (channel > 0) ? 
+    String::formatted("TO CHANNEL %d", channel) : String("ANY CHANNEL");
+  drawButton(g, remapArea, remapText, channel > 0);
+  drawButton(g, monitorArea, String("MONITOR SYNTH"), processor.guitar.monitor);
+  int polyphony = processor.guitar.polyphony;
+  drawButton(g, polyphonyArea, String::formatted("VOICES: %d", polyphony), 
+             polyphony < 6);
+  const char *stealNames[StealPolicyCount] = { "OLDEST", "QUIETEST", "LOWEST" };
+  int stealPolicy = processor.guitar.stealPolicy;
+  if ((stealPolicy < 0) || (stealPolicy >= StealPolicyCount)) stealPolicy = StealOldest;
+  drawButton(g, stealArea, String("STEAL: ") + String(stealNames[stealPolicy]), false);
+  const char *curveNames[CurveCount] = 
+    { "LINEAR", "INVERSE", "EXPONENTIAL", "USER" };
+  int curve = processor.guitar.velocityCurve;
+  if ((curve < 0) || (curve >= CurveCount)) curve = CurveInverse;
+  drawButton(g, curveMenuArea, 
+             String("CURVE: ") + String(curveNames[curve]), false);
 }
 
 void StanginAudioProcessorEditor::resized() {
@@ -59,19 +93,40 @@ void StanginAudioProcessorEditor::resized() {
   detuneArea = area.withHeight(sliderHeight);
   area = area.withTrimmedTop(sliderHeight + (spacing / 2));
   sustainArea = area.withHeight(sliderHeight);
+  area = area.withTrimmedTop(sliderHeight + (spacing / 2));
+  reconcileArea = area.withHeight(sliderHeight);
   area = area.withTrimmedTop(sliderHeight + spacing);
   // position the buttons
   area = area.withTrimmedTop(spacing / 2);
   int buttonSpacing = spacing / 2;
-  area = area.withHeight(em);
-  hammeronArea = area.withWidth(em * 5);
-  area = area.withTrimmedLeft(hammeronArea.getWidth() + buttonSpacing);
-  pulloffArea = area.withWidth(em * 4);
-  area = area.withTrimmedLeft(pulloffArea.getWidth() + buttonSpacing);
-  dampOpenArea = area.withWidth(em * 5);
-  area = area.withTrimmedLeft(dampOpenArea.getWidth() + buttonSpacing);
-  tapArea = area.withWidth(em * 3);
-  area = area.withTrimmedLeft(tapArea.getWidth() + buttonSpacing);
+  Rectangle<int> buttonArea = area.withHeight(em);
+  hammeronArea = buttonArea.withWidth(em * 5);
+  buttonArea = buttonArea.withTrimmedLeft(hammeronArea.getWidth() + buttonSpacing);
+  pulloffArea = buttonArea.withWidth(em * 4);
+  buttonArea = buttonArea.withTrimmedLeft(pulloffArea.getWidth() + buttonSpacing);
+  dampOpenArea = buttonArea.withWidth(em * 5);
+  buttonArea = buttonArea.withTrimmedLeft(dampOpenArea.getWidth() + buttonSpacing);
+  tapArea = buttonArea.withWidth(em * 3);
+  area = area.withTrimmedTop(em + buttonSpacing);
+  buttonArea = area.withHeight(em);
+  mergeArea = buttonArea.withWidth(em * 5);
+  buttonArea = buttonArea.withTrimmedLeft(mergeArea.getWidth() + buttonSpacing);
+  remapArea = buttonArea.withWidth(em * 6);
+  buttonArea = buttonArea.withTrimmedLeft(remapArea.getWidth() + buttonSpacing);
+  curveMenuArea = buttonArea;
+  area = area.withTrimmedTop(em + buttonSpacing);
+  buttonArea = area.withHeight(em);
+  monitorArea = buttonArea.withWidth(em * 7);
+  buttonArea = buttonArea.withTrimmedLeft(monitorArea.getWidth() + buttonSpacing);
+  polyphonyArea = buttonArea.withWidth(em * 4);
+  buttonArea = buttonArea.withTrimmedLeft(polyphonyArea.getWidth() + buttonSpacing);
+  stealArea = buttonArea;
+  area = area.withTrimmedTop(em + buttonSpacing);
+  // position the velocity curve
+  curveArea = area.withHeight(em * 3);
+  area = area.withTrimmedTop(curveArea.getHeight() + spacing);
+  // position the tablature at the bottom
+  tabArea = area;
 }
 
 // draw the strings display
@@ -120,8 +175,9 @@ void StanginAudioProcessorEditor::drawStrings(Graphics &g) {
       Justification::verticallyCentred | Justification::right, 1);
     // get the fraction of the string's playback time that has elapsed
     float life = 0.0f;
-    if (string.samplesSustain > 0) {
-      life = ((double)string.samplesLeft / (double)(string.samplesSustain));
+    int64 samplesLeft = string.endTime - processor.samplePosition.get();
+    if ((string.samplesSustain > 0) && (samplesLeft > 0)) {
+      life = ((double)samplesLeft / (double)(string.samplesSustain));
     }
     // draw the string with a corresponding color
     g.setColour(bg.interpolatedWith(fg, 0.25f + (life * 0.75f)));
@@ -147,6 +203,93 @@ void StanginAudioProcessorEditor::drawStrings(Graphics &g) {
   }
 }
 
+// draw the curve mapping pick velocity to output velocity
+void StanginAudioProcessorEditor::drawCurve(Graphics &g) {
+  Rectangle<float> r = curveArea.toFloat();
+  g.setColour(bg.interpolatedWith(fg, 0.1));
+  g.fillRect(r);
+  Path p;
+  p.startNewSubPath(r.getX(), r.getBottom());
+  for (int v = 1; v < 128; v++) {
+    double level = StanginAudioProcessor::getCurveLevel(processor.guitar, v);
+    p.lineTo(r.getX() + (r.getWidth() * (float)v / 127.0f), 
+             r.getBottom() - (r.getHeight() * (float)level));
+  }
+  g.setColour(processor.guitar.velocityCurve == CurveUser ? accent : fg);
+  g.strokePath(p, PathStrokeType(2.0f));
+  g.setColour(bg.interpolatedWith(fg, 0.33f));
+  g.setFont(smallFont);
+  g.drawFittedText(String("PICK VELOCITY"), curveArea.reduced(em / 4), 
+      Justification::right | Justification::bottom, 1);
+}
+
+// draw the tablature history
+void StanginAudioProcessorEditor::drawTablature(Graphics &g) {
+  if (tabImage.isValid()) {
+    g.drawImageAt(tabImage, tabArea.getX(), tabArea.getY());
+  }
+}
+
+// scroll the tablature history and draw any new events into it, so the cost 
+//  of a frame depends only on the time elapsed and not on the history length
+void StanginAudioProcessorEditor::updateTablature() {
+  int i, x;
+  int w = tabArea.getWidth();
+  int h = tabArea.getHeight();
+  if ((w <= 0) || (h <= 0)) return;
+  int stringHeight = h / 6;
+  Colour stringColour = bg.interpolatedWith(fg, 0.25f);
+  // get the number of samples represented by a column of pixels
+  int64 columnSamples = (int64)(processor.getSampleRate() * tabSecondsPerColumn);
+  if (columnSamples < 1) columnSamples = 1;
+  int64 column = processor.samplePosition.get() / columnSamples;
+  // start over if the display area has changed
+  if ((! tabImage.isValid()) || 
+      (tabImage.getWidth() != w) || (tabImage.getHeight() != h)) {
+    tabImage = Image(Image::RGB, w, h, false);
+    tabColumn = column - w;
+  }
+  Graphics g(tabImage);
+  // scroll the existing image and clear the columns that were exposed
+  int64 shift = column - tabColumn;
+  if (shift > w) shift = w;
+  if (shift > 0) {
+    if (shift < w) {
+      tabImage.moveImageSection(0, 0, (int)shift, 0, w - (int)shift, h);
+    }
+    x = w - (int)shift;
+    g.setColour(bg);
+    g.fillRect(x, 0, (int)shift, h);
+    g.setColour(stringColour);
+    for (i = 0; i < 6; i++) {
+      g.fillRect(x, (i * stringHeight) + (stringHeight / 2), (int)shift, 1);
+    }
+  }
+  if (column > tabColumn) tabColumn = column;
+  // draw fret numbers for new events with their right edges at the event time
+  TabEvent events[64];
+  int count;
+  g.setFont(smallFont);
+  while ((count = processor.readTabEvents(events, 64)) > 0) {
+    for (i = 0; i < count; i++) {
+      TabEvent &event = events[i];
+      if (event.string >= 6) continue;
+      x = w - (int)(tabColumn - (event.time / columnSamples));
+      if (x > w) x = w;
+      if (x <= 0) continue;
+      String fretNumber = String(event.fret);
+      int fretWidth = smallFont.getStringWidth(fretNumber) + 2;
+      int y = event.string * stringHeight;
+      g.setColour(bg);
+      g.fillRect(x - fretWidth, y, fretWidth, stringHeight);
+      g.setColour(bg.interpolatedWith(fg, 
+        0.25f + (0.75f * ((float)event.velocity / 127.0f))));
+      g.drawFittedText(fretNumber, x - fretWidth, y, fretWidth, stringHeight, 
+                       Justification::centred, 1);
+    }
+  }
+}
+
 void StanginAudioProcessorEditor::drawTuningMenu(Graphics &g) {
   Path p;
   Rectangle<float>r = tuningMenuArea.toFloat();
@@ -218,10 +361,21 @@ void StanginAudioProcessorEditor::mouseDown(const MouseEvent &event) {
     setDetuneFraction(getSliderFraction(event, detuneArea));
     detuneActive = true;
   }
+  else if (reconcileArea.contains(position)) {
+    setReconcileFraction(getSliderFraction(event, reconcileArea));
+    reconcileActive = true;
+  }
+  else if (curveArea.contains(position)) {
+    lastCurveVelocity = -1;
+    setCurvePoint(event);
+  }
 }
 void StanginAudioProcessorEditor::mouseUp(const MouseEvent &event) {
+  // report latency once the window has been chosen, not at every step
+  if (reconcileActive) processor.updateLatency();
   sustainActive = false;
   detuneActive = false;
+  reconcileActive = false;
   // toggle buttons on click
   Point<int> position = event.getMouseDownPosition().toInt();
   if (hammeronArea.contains(position)) {
@@ -236,6 +390,47 @@ void StanginAudioProcessorEditor::mouseUp(const MouseEvent &event) {
   else if (tapArea.contains(position)) {
     processor.guitar.tap = ! processor.guitar.tap;
   }
+  else if (monitorArea.contains(position)) {
+    processor.guitar.monitor = ! processor.guitar.monitor;
+  }
+  // cycle through polyphony limits, from fewest voices to no limit
+  else if (polyphonyArea.contains(position)) {
+    processor.guitar.polyphony = (processor.guitar.polyphony % 6) + 1;
+  }
+  else if (stealArea.contains(position)) {
+    processor.guitar.stealPolicy = 
+      (processor.guitar.stealPolicy + 1) % StealPolicyCount;
+  }
+  // choose which classes of message to merge
+  else if (mergeArea.contains(position)) {
+    const char *classNames[6] = { "Notes", "Controllers", "Program changes", 
+      "Channel pressure", "Pitch bend", "System (clock, transport)" };
+    int passthrough = processor.guitar.passthrough;
+    PopupMenu mergeMenu;
+    for (int i = 0; i < 6; i++) {
+      mergeMenu.addItem(1 << i, classNames[i], true, (passthrough & (1 << i)) != 0);
+    }
+    mergeMenu.addSeparator();
+    mergeMenu.addItem(PassAll + 1, "All", passthrough != PassAll);
+    mergeMenu.addItem(PassAll + 2, "None", passthrough != 0);
+    int item = showMenu(mergeMenu, mergeArea);
+    if (item == PassAll + 1) passthrough = PassAll;
+    else if (item == PassAll + 2) passthrough = 0;
+    else if (item > 0) passthrough ^= item;
+    processor.guitar.passthrough = passthrough;
+  }
+  else if (curveMenuArea.contains(position)) {
+    processor.guitar.velocityCurve = 
+      (processor.guitar.velocityCurve + 1) % CurveCount;
+  }
+  // cycle through the channels that don't collide with string channels
+  else if (remapArea.contains(position)) {
+    int channel = processor.guitar.passthroughChannel;
+    if (channel <= 0) channel = 7;
+    else if (channel >= 16) channel = 0;
+    else channel++;
+    processor.guitar.passthroughChannel = channel;
+  }
   // update string tuning on click
   else if (tuningArea.contains(position)) {
     int stringHeight = tuningArea.getHeight() / 6;
@@ -252,20 +447,25 @@ void StanginAudioProcessorEditor::mouseUp(const MouseEvent &event) {
   }
   // show the list of tunings on click
   else if (tuningMenuArea.contains(position)) {
-    LookAndFeel_V3 look;
-    look.setColour(PopupMenu::ColourIds::backgroundColourId, bg);
-    look.setColour(PopupMenu::ColourIds::textColourId, fg);
-    look.setColour(PopupMenu::ColourIds::highlightedBackgroundColourId, accent);
-    look.setColour(PopupMenu::ColourIds::highlightedTextColourId, fg);
-    tuningMenu.setLookAndFeel(&look);
-    int idx = tuningMenu.showAt(localAreaToGlobal(tuningMenuArea)) - 1;
-    if ((idx >= 0) && (idx < tunings.size())) {
+    TuningLibrary &library = *processor.tuningLibrary;
+    int idx = showMenu(library.menu, tuningMenuArea) - 1;
+    if ((idx >= 0) && (idx < library.tunings.size())) {
       for (int i = 0; i < 6; i++) {
-        processor.guitar.string[i].openNote = tunings[idx].string[i];
+        processor.guitar.string[i].openNote = library.tunings[idx].string[i];
       }
     }
   }
 }
+// show a menu in the editor's colors below an area and return the chosen item
+int StanginAudioProcessorEditor::showMenu(PopupMenu menu, Rectangle<int> area) {
+  LookAndFeel_V3 look;
+  look.setColour(PopupMenu::ColourIds::backgroundColourId, bg);
+  look.setColour(PopupMenu::ColourIds::textColourId, fg);
+  look.setColour(PopupMenu::ColourIds::highlightedBackgroundColourId, accent);
+  look.setColour(PopupMenu::ColourIds::highlightedTextColourId, fg);
+  menu.setLookAndFeel(&look);
+  return(menu.showAt(localAreaToGlobal(area)));
+}
 // drag sliders
 void StanginAudioProcessorEditor::mouseDrag(const MouseEvent &event) {
   Point<int> position = event.getMouseDownPosition().toInt();
@@ -275,6 +475,12 @@ void StanginAudioProcessorEditor::mouseDrag(const MouseEvent &event) {
   else if (detuneArea.contains(position)) {
     setDetuneFraction(getSliderFraction(event, detuneArea));
   }
+  else if (reconcileArea.contains(position)) {
+    setReconcileFraction(getSliderFraction(event, reconcileArea));
+  }
+  else if (curveArea.contains(position)) {
+    setCurvePoint(event);
+  }
 }
 // reset on double-click of sliders
 void StanginAudioProcessorEditor::mouseDoubleClick(const MouseEvent &event) {
@@ -285,12 +491,48 @@ void StanginAudioProcessorEditor::mouseDoubleClick(const MouseEvent &event) {
   else if (detuneArea.contains(position)) {
     setDetuneFraction(0.5);
   }
+  else if (reconcileArea.contains(position)) {
+    setReconcileFraction(0.0);
+    processor.updateLatency();
+  }
 }
 
 float StanginAudioProcessorEditor::getSliderFraction(const MouseEvent &event, const Rectangle<int> area) {
   return((float)(event.x - area.getX()) / (float)area.getWidth());
 }
 
+// draw on the user velocity curve, starting from the selected curve
+void StanginAudioProcessorEditor::setCurvePoint(const MouseEvent &event) {
+  GuitarState &guitar = processor.guitar;
+  int v;
+  if (guitar.velocityCurve != CurveUser) {
+    uint8_t curve[128];
+    for (v = 0; v < 128; v++) {
+      curve[v] = (uint8_t)(StanginAudioProcessor::getCurveLevel(guitar, v) * 127.0);
+    }
+    memcpy(guitar.userCurve, curve, sizeof(curve));
+    // keep sustaining softer picks longer when drawing from the inverse curve
+    guitar.userCurveInverse = (guitar.velocityCurve == CurveInverse);
+    guitar.velocityCurve = CurveUser;
+  }
+  int velocity = (int)(getSliderFraction(event, curveArea) * 127.0f);
+  int value = (int)((float)(curveArea.getBottom() - event.y) * 127.0f / 
+                    (float)curveArea.getHeight());
+  velocity = jlimit(1, 127, velocity);
+  value = jlimit(0, 127, value);
+  // fill in velocities skipped over since the last point
+  if (lastCurveVelocity < 0) lastCurveVelocity = velocity;
+  int step = (velocity >= lastCurveVelocity) ? 1 : -1;
+  int span = abs(velocity - lastCurveVelocity);
+  for (v = lastCurveVelocity; v != velocity + step; v += step) {
+    int i = abs(v - lastCurveVelocity);
+    guitar.userCurve[v] = (uint8_t)((span > 0) ? 
+      lastCurveValue + (((value - lastCurveValue) * i) / span) : value);
+  }
+  lastCurveVelocity = velocity;
+  lastCurveValue = value;
+}
+
 // update sustain
 void StanginAudioProcessorEditor::setSustainFraction(float f) {
   if (f < 0.0f) f = 0.0f;
@@ -303,6 +545,18 @@ float StanginAudioProcessorEditor::getSustainFraction() {
          (processor.maxSustain - processor.minSustain));
 }
 
+// update the reconciliation window
+void StanginAudioProcessorEditor::setReconcileFraction(float f) {
+  if (f < 0.0f) f = 0.0f;
+  if (f > 1.0f) f = 1.0f;
+  // round to whole milliseconds
+  processor.guitar.reconcileWindow = 
+    floor(f * processor.maxReconcileWindow * 1000.0f + 0.5f) / 1000.0;
+}
+float StanginAudioProcessorEditor::getReconcileFraction() {
+  return((float)processor.guitar.reconcileWindow / processor.maxReconcileWindow);
+}
+
 // update detune
 void StanginAudioProcessorEditor::setDetuneFraction(float f) {
   if (f < 0.0f) f = 0.0f;
@@ -337,79 +591,3 @@ String StanginAudioProcessorEditor::noteName(int note, bool withOctave) {
     default: return(String("?"));
   }
 }
-
-// initialize the tuning menu
-void StanginAudioProcessorEditor::initTuningMenu() {
-  addTuning("Standard",      "E",  "A",  "D",  "G",  "B",  "E");
-  addTuning("Dad-Gad",  "D",  "A",  "D",  "G",  "A",  "D");
-  addTuning("Dad-Dad",  "D",  "A",  "D",  "D",  "A",  "D");
-  tuningMenu.addSeparator();
-  addTuning("Open A",        "E",  "A",  "C#", "E",  "A",  "E");
-  addTuning("Open B",        "B",  "F#", "B",  "F#", "B",  "D#");
-  addTuning("Open C",        "C",  "G",  "C",  "G",  "C",  "E");
-  addTuning("Open D",        "D",  "A",  "D",  "F#", "A",  "D");
-  addTuning("Open E",        "E",  "B",  "E",  "G#", "B",  "E");
-  addTuning("Open F",        "F",  "A",  "C",  "F",  "C",  "F");
-  addTuning("Open G",        "D",  "G",  "D",  "G",  "B",  "D");
-  tuningMenu.addSeparator();
-  addTuning("Cross-note A",  "E",  "A",  "E",  "A",  "C",  "E");
-  addTuning("Cross-note C",  "C",  "G",  "C",  "G",  "C",  "E");
-  addTuning("Cross-note D",  "D",  "A",  "D",  "F",  "A",  "D");
-  addTuning("Cross-note E",  "E",  "B",  "E",  "G",  "B",  "E");
-  addTuning("Cross-note G",  "D",  "G",  "D",  "G",  "Bb", "D");
-  tuningMenu.addSeparator();
-  addTuning("Major Thirds",  "E",  "G#", "C",  "E",  "G#", "C");
-  addTuning("All Fourths",   "E",  "A",  "D",  "G",  "C",  "F");
-  addTuning("Aug Fourths",   "C",  "F#", "C",  "F#", "C",  "F#");
-  addTuning("All Fifths",    "C",  "G",  "D",  "A",  "E",  "G");
-  tuningMenu.addSeparator();
-  addTuning("Drop D",        "D",  "A",  "D",  "G",  "B",  "E");
-  addTuning("Double Drop D", "D",  "A",  "D",  "G",  "B",  "D");  
-}
-
-void StanginAudioProcessorEditor::addTuning(const char *name, 
-                              const char *s0, const char *s1, const char *s2, 
-                              const char *s3, const char *s4, const char *s5) {
-  int i = tunings.size();
-  Tuning newTuning;
-  newTuning.string[5] = nextNote(35, s0);
-  newTuning.string[4] = nextNote(newTuning.string[5], s1);
-  newTuning.string[3] = nextNote(newTuning.string[4], s2);
-  newTuning.string[2] = nextNote(newTuning.string[3], s3);
-  newTuning.string[1] = nextNote(newTuning.string[2], s4);
-  newTuning.string[0] = nextNote(newTuning.string[1], s5);
-  tunings.add(newTuning);
-  String label = String::formatted("%s-%s-%s-%s-%s-%s", s0, s1, s2, s3, s4, s5);
-  String nameString(name);
-  if (! nameString.isEmpty()) {
-    label += String::formatted(" (%s)", name);
-  }
-  tuningMenu.addItem(i + 1, label);
-}
-
-uint8_t StanginAudioProcessorEditor::nextNote(uint8_t note, const char *pitchClass) {
-  uint8_t pitchOffset = getOffsetForPitchClass(pitchClass);
-  while (note % 12 != pitchOffset) note++;
-  return(note);
-}
-uint8_t StanginAudioProcessorEditor::getOffsetForPitchClass(const char *pitchClass) {
-  String s(pitchClass);
-  if (s.equalsIgnoreCase("C")) return(0);
-  if (s.equalsIgnoreCase("C#")) return(1);
-  if (s.equalsIgnoreCase("Db")) return(1);
-  if (s.equalsIgnoreCase("D")) return(2);
-  if (s.equalsIgnoreCase("D#")) return(3);
-  if (s.equalsIgnoreCase("Eb")) return(3);
-  if (s.equalsIgnoreCase("E")) return(4);
-  if (s.equalsIgnoreCase("F")) return(5);
-  if (s.equalsIgnoreCase("F#")) return(6);
-  if (s.equalsIgnoreCase("Gb")) return(6);
-  if (s.equalsIgnoreCase("G")) return(7);
-  if (s.equalsIgnoreCase("G#")) return(8);
-  if (s.equalsIgnoreCase("Ab")) return(8);
-  if (s.equalsIgnoreCase("A")) return(9);
-  if (s.equalsIgnoreCase("A#")) return(10);
-  if (s.equalsIgnoreCase("Bb")) return(10);
-  if (s.equalsIgnoreCase("B")) return(11);
-  return(0);
-}
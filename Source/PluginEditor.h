@@ -1,13 +1,9 @@
 #ifndef PLUGINEDITOR_H_INCLUDED
 #define PLUGINEDITOR_H_INCLUDED
 
-#include "../JuceLibraryCode/JuceHeader.h"
+#include "JuceHeader.h"
 #include "PluginProcessor.h"
 
-typedef struct {
-  uint8_t string[6];
-} Tuning;
-
 class StanginAudioProcessorEditor  : public AudioProcessorEditor, public Timer {
   public:
     StanginAudioProcessorEditor (StanginAudioProcessor&);
@@ -17,7 +13,11 @@ class StanginAudioProcessorEditor  : public AudioProcessorEditor, public Timer {
     void resized() override;
     
     void drawStrings(Graphics &g);
+    void drawTablature(Graphics &g);
+    void drawCurve(Graphics &g);
     void drawTuningMenu(Graphics &g);
+    void drawSliders(Graphics &g);
+    void drawButtons(Graphics &g);
     void drawSlider(Graphics &g, Rectangle<int> area, String text, float value, bool active);
     void drawButton(Graphics &g, Rectangle<int> area, String text, bool on);
     
@@ -38,36 +38,53 @@ class StanginAudioProcessorEditor  : public AudioProcessorEditor, public Timer {
     Rectangle<int> tuningArea; // the area that displays the current tuning
     Rectangle<int> tuningMenuArea; // the button area for a menu of tunings
     Rectangle<int> sustainArea; // the area for the sustain slider
+    Rectangle<int> reconcileArea; // the area for the reconciliation window slider
     Rectangle<int> detuneArea; // the area for the detune slider
     Rectangle<int> hammeronArea; // the area for the hammer-on toggle
     Rectangle<int> pulloffArea; // the area for the pull-off toggle
     Rectangle<int> dampOpenArea; // the area for the damp open toggle
     Rectangle<int> tapArea; // the area for the tap toggle
+    Rectangle<int> mergeArea; // the area for the MIDI merge toggle
+    Rectangle<int> remapArea; // the area for the merge channel selector
+    Rectangle<int> monitorArea; // the area for the monitor synth toggle
+    Rectangle<int> polyphonyArea; // the area for the polyphony selector
+    Rectangle<int> stealArea; // the area for the voice stealing policy selector
+    Rectangle<int> curveMenuArea; // the area for the velocity curve selector
+    Rectangle<int> curveArea; // the area for the velocity curve graph
+    Rectangle<int> tabArea; // the area for the scrolling tablature
     // whether the user is changing slider values
     bool sustainActive = false;
+    bool reconcileActive = false;
     bool detuneActive = false;
     
-    // a popup menu of tunings
-    PopupMenu tuningMenu;
-    // tunings keyed by index
-    Array<Tuning> tunings;
-    // initialize the tuning menu
-    void initTuningMenu();
-    void addTuning(const char *name, 
-      const char *s0, const char *s1, const char *s2, 
-      const char *s3, const char *s4, const char *s5);
-    uint8_t nextNote(uint8_t note, const char *pitchClass);
-    uint8_t getOffsetForPitchClass(const char *pitchClass);
+    // the last point drawn on the user velocity curve
+    int lastCurveVelocity = -1;
+    int lastCurveValue = 0;
+    // draw the user velocity curve at a mouse position
+    void setCurvePoint(const MouseEvent &event);
+    
+    // a rendered history of played notes, scrolled as time passes
+    Image tabImage;
+    int64 tabColumn = -1; // the timeline column at the right edge of the image
+    float tabSecondsPerColumn = 0.02f; // the time spanned by each pixel column
+    // draw new tablature columns and events into the history image
+    void updateTablature();
     
     // get the value a slider should have for the given mouse position
     float getSliderFraction(const MouseEvent &event, const Rectangle<int> area);
     // update sustain
     void setSustainFraction(float f);
     float getSustainFraction();
+    // update the reconciliation window
+    void setReconcileFraction(float f);
+    float getReconcileFraction();
     // update detune
     void setDetuneFraction(float f);
     float getDetuneFraction();
     
+    // show a menu below an area and return the chosen item, or 0 if none
+    int showMenu(PopupMenu menu, Rectangle<int> area);
+    
     // get the name of a MIDI note, optionally with octave number
     String noteName(int note, bool withOctave);
 
@@ -1,8 +1,11 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
-StanginAudioProcessor::StanginAudioProcessor() {
+StanginAudioProcessor::StanginAudioProcessor() 
+    : tabFifo(tabFifoSize) {
   guitar = resetState(guitar);
+  // start the user curve as a straight line
+  for (int i = 0; i < 128; i++) guitar.userCurve[i] = (uint8_t)i;
 }
 
 StanginAudioProcessor::~StanginAudioProcessor() {
@@ -11,8 +14,15 @@ StanginAudioProcessor::~StanginAudioProcessor() {
 // FILTER *********************************************************************
 
 void StanginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock) {
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
+  synth.prepare(sampleRate);
+  updateLatency();
+}
+
+// report the reconciliation window to the host as latency, which must only 
+//  be done from the message thread because hosts respond synchronously
+void StanginAudioProcessor::updateLatency() {
+  int latency = jmax(0, (int)(guitar.reconcileWindow * getSampleRate()));
+  if (latency != getLatencySamples()) setLatencySamples(latency);
 }
 
 void StanginAudioProcessor::releaseResources() {
@@ -21,47 +31,201 @@ void StanginAudioProcessor::releaseResources() {
 }
 
 void StanginAudioProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuffer& input) {
-  GuitarState newState;
-  // buffer for sysex data
+  TRACE_SCOPE("processBlock");
+  // keep the monitor synth's decaying lines fast without changing the 
+  //  floating point mode of the host's thread
+  ScopedDenormalFlush denormalFlush;
+  // raw message data, read in place from the input buffer
   const uint8_t *data;
   int dataSize;
   // buffer for outgoing messages
   MidiBuffer output;
   // read incoming messages
   MidiBuffer::Iterator i(input);
-  MidiMessage msg(0xF0);
-  int lastSample = 0;
+  // the only audio is the optional sound of the monitor synth, which starts 
+  //  out silent each time it's turned on
+  bool wasMonitoring = monitoring;
+  monitoring = (guitar.monitor) && (buffer.getNumChannels() > 0);
+  if ((monitoring) && (! wasMonitoring)) synth.reset();
+  // when bouncing, skip everything that only feeds displays
+  offline = isNonRealtime();
+  buffer.clear();
+  blockStart = samplePosition.get();
+  lastTime = blockStart;
+  int64 time = blockStart + buffer.getNumSamples();
   int sample;
-  while (i.getNextEvent(msg, sample)) {
-    if (! msg.isSysEx()) continue;
-    data = msg.getSysExData();
-    dataSize = msg.getSysExDataSize();
-    if (dataSize < 4) continue;
-    guitar = ageGuitarState(guitar, lastSample, sample, output);
-    newState = updateGuitarState(guitar, sample, data, dataSize);
-    if (newState.dirty) {
-      guitar = sendNotes(guitar, newState, output);
-      AudioProcessorEditor *editor = getActiveEditor();
+  // when the reconciliation window changes, move held messages to the time 
+  //  the new window gives them, but never before this block so that handled 
+  //  times don't go backwards
+  int windowSamples = jmax(0, (int)(guitar.reconcileWindow * getSampleRate()));
+  if (windowSamples != queueWindow) {
+    for (int j = 0; j < queueCount; j++) {
+      QueuedMessage &message = queue[(queueStart + j) % messageQueueSize];
+      message.time = jmax(blockStart, message.time + (windowSamples - queueWindow));
     }
-    lastSample = sample;
+    queueWindow = windowSamples;
   }
-  guitar = ageGuitarState(guitar, lastSample, buffer.getNumSamples() - 1, output);
+  // with no window, handle messages as they come in, after any still held 
+  //  from a larger window
+  if (windowSamples == 0) {
+    processQueue(time, buffer, output);
+    while (i.getNextEvent(data, dataSize, sample)) {
+      processMessage(data, dataSize, blockStart + sample, buffer, output);
+    }
+  }
+  // otherwise hold messages for the length of the window, so picks can be 
+  //  matched with fret changes that arrive shortly after them
+  else {
+    while (i.getNextEvent(data, dataSize, sample)) {
+      queueMessage(data, dataSize, blockStart + sample + windowSamples);
+    }
+    processQueue(time, buffer, output);
+  }
+  if (monitoring) {
+    synth.render(buffer, getBlockSample(lastTime), getBlockSample(time));
+  }
+  guitar = ageGuitarState(guitar, lastTime, time - 1, output);
+  // advance the timeline
+  samplePosition = time;
+  if (! offline) publishState(time);
   // swap in the output buffer
   input.swapWith(output);
 }
 
+// handle a MIDI message at the given output time
+void StanginAudioProcessor::processMessage(const uint8_t *data, int dataSize, int64 time, 
+                                           AudioSampleBuffer &buffer, MidiBuffer &output) {
+  TRACE_SCOPE("processMessage");
+  GuitarState newState;
+  if (dataSize < 1) return;
+  // drop messages too long to hold the same way whether or not they're held
+  if (dataSize > maxMessageSize) {
+    eventLog.write(LogOversizeMessage, time, data, dataSize);
+    return;
+  }
+  // pass through other messages if enabled
+  if (data[0] != 0xF0) {
+    if (guitar.passthrough & getPassthroughClass(data[0])) {
+      passMessage(data, dataSize, getBlockSample(time), output);
+    }
+    return;
+  }
+  // strip the sysex start and end bytes
+  data += 1;
+  dataSize -= 2;
+  if (dataSize < 4) {
+    eventLog.write(LogShortSysex, time, data, dataSize);
+    return;
+  }
+  if (monitoring) {
+    synth.render(buffer, getBlockSample(lastTime), getBlockSample(time));
+  }
+  // aging does nothing until a string runs out of sustain or a held button 
+  //  repeats, so when bouncing only do it once one of those is due
+  if ((! offline) || (time >= getAgeDeadline(guitar))) {
+    guitar = ageGuitarState(guitar, lastTime, time, output);
+  }
+  updateCurveTables(guitar);
+  // apply a held fret change for the same string before a pick, so the 
+  //  pick sounds the right note the first time
+  newState = guitar;
+  if ((data[3] == 0x05) && (dataSize >= 5)) {
+    QueuedMessage *fretChange = findFretChange(data[4], time + queueWindow);
+    if (fretChange != nullptr) {
+      newState = updateGuitarState(newState, time, 
+                                   fretChange->data + 1, fretChange->size - 2);
+      fretChange->consumed = true;
+    }
+  }
+  newState = updateGuitarState(newState, time, data, dataSize);
+  if (newState.dirty) {
+    guitar = sendNotes(guitar, newState, output);
+  }
+  lastTime = time;
+}
+
+// hold a message until the given output time
+void StanginAudioProcessor::queueMessage(const uint8_t *data, int dataSize, int64 time) {
+  TRACE_SCOPE("queueMessage");
+  if (queueCount >= messageQueueSize) {
+    eventLog.write(LogQueueOverflow, time, data, dataSize);
+    return;
+  }
+  // log and drop longer messages rather than truncating them
+  if (dataSize > maxMessageSize) {
+    eventLog.write(LogOversizeMessage, time, data, dataSize);
+    return;
+  }
+  QueuedMessage &message = queue[(queueStart + queueCount) % messageQueueSize];
+  message.time = time;
+  message.size = dataSize;
+  memcpy(message.data, data, dataSize);
+  message.consumed = false;
+  queueCount++;
+}
+
+// handle held messages that are due before the given time
+void StanginAudioProcessor::processQueue(int64 endTime, AudioSampleBuffer &buffer, MidiBuffer &output) {
+  while ((queueCount > 0) && (queue[queueStart].time < endTime)) {
+    QueuedMessage &message = queue[queueStart];
+    if (! message.consumed) {
+      processMessage(message.data, message.size, message.time, buffer, output);
+    }
+    queueStart = (queueStart + 1) % messageQueueSize;
+    queueCount--;
+  }
+}
+
+// find a held fret change for a string, stopping at the given time or the 
+//  string's next pick
+StanginAudioProcessor::QueuedMessage *StanginAudioProcessor::findFretChange(uint8_t string, int64 endTime) {
+  // skip the message being handled
+  for (int i = 1; i < queueCount; i++) {
+    QueuedMessage &message = queue[(queueStart + i) % messageQueueSize];
+    if (message.time > endTime) break;
+    if ((message.consumed) || (message.size < 8) || (message.data[0] != 0xF0) || 
+        (message.data[5] != string)) continue;
+    if (message.data[4] == 0x05) break;
+    if (message.data[4] == 0x01) return(&message);
+  }
+  return(nullptr);
+}
+
+// get the passthrough class of a MIDI message from its status byte
+int StanginAudioProcessor::getPassthroughClass(uint8_t status) {
+  switch (status & 0xF0) {
+    case 0x80: return(PassNotes);
+    case 0x90: return(PassNotes);
+    case 0xA0: return(PassNotes);
+    case 0xB0: return(PassControllers);
+    case 0xC0: return(PassPrograms);
+    case 0xD0: return(PassPressure);
+    case 0xE0: return(PassPitchBend);
+    case 0xF0: return((status == 0xF0) || (status == 0xF7) ? 0 : PassSystem);
+    default: return(0);
+  }
+}
+
+// copy a message to the output, moving it to the passthrough channel if set
+void StanginAudioProcessor::passMessage(const uint8_t *data, int dataSize, int sample, MidiBuffer &output) {
+  TRACE_SCOPE("passMessage");
+  uint8_t remapped[3];
+  int channel = guitar.passthroughChannel;
+  if ((channel >= 1) && (channel <= 16) && (data[0] < 0xF0) && 
+      (dataSize <= 3)) {
+    remapped[0] = (data[0] & 0xF0) | (uint8_t)(channel - 1);
+    for (int i = 1; i < dataSize; i++) remapped[i] = data[i];
+    data = remapped;
+  }
+  output.addEvent(data, dataSize, sample);
+}
+
 GuitarState StanginAudioProcessor::resetState(GuitarState state) {
   int i;
-  // reset the tuning
-  state.string[0].openNote = 0x40;
-  state.string[1].openNote = 0x3B;
-  state.string[2].openNote = 0x37;
-  state.string[3].openNote = 0x32;
-  state.string[4].openNote = 0x2D;
-  state.string[5].openNote = 0x28;
-  // stop all strings
+  // reset to standard tuning and stop all strings
   for (i = 0; i < 6; i++) {
-    state.string[i].samplesLeft = 0;
+    state.string[i].openNote = builtinTunings[0].tuning.string[i];
+    state.string[i].endTime = 0;
     state.string[i].velocity = 0;
   }
   // clear all button presses
@@ -80,16 +244,63 @@ GuitarState StanginAudioProcessor::resetState(GuitarState state) {
   return(state);
 }
 
+// get the output level for a pick velocity, where 1.0 is the loudest
+double StanginAudioProcessor::getCurveLevel(const GuitarState &state, int velocity) {
+  double x = (double)velocity / 127.0;
+  switch (state.velocityCurve) {
+    case CurveExponential: return((exp(3.0 * x) - 1.0) / (exp(3.0) - 1.0));
+    case CurveUser: return((double)state.userCurve[velocity & 0x7F] / 127.0);
+    default: return(x);
+  }
+}
+
+// rebuild the velocity and sustain lookup tables if their inputs have changed
+void StanginAudioProcessor::updateCurveTables(const GuitarState &state) {
+  double sampleRate = getSampleRate();
+  if ((state.velocityCurve == tableCurve) && (state.sustain == tableSustain) && 
+      (sampleRate == tableSampleRate) && ((state.velocityCurve != CurveUser) || 
+        ((state.userCurveInverse == tableUserCurveInverse) && 
+         (memcmp(state.userCurve, tableUserCurve, sizeof(tableUserCurve)) == 0)))) {
+    return;
+  }
+  tableCurve = state.velocityCurve;
+  tableSustain = state.sustain;
+  tableSampleRate = sampleRate;
+  memcpy(tableUserCurve, state.userCurve, sizeof(tableUserCurve));
+  tableUserCurveInverse = state.userCurveInverse;
+  double maxSustain = state.sustain * sampleRate;
+  velocityTable[0] = 0;
+  sustainTable[0] = 0;
+  for (int v = 1; v < 128; v++) {
+    double level = getCurveLevel(state, v);
+    int velocity = (int)(level * 127.0 + 0.5);
+    if (velocity < 1) velocity = 1;
+    if (velocity > 127) velocity = 127;
+    velocityTable[v] = (uint8_t)velocity;
+    // the inverse curve keeps the velocity but sustains softer picks longer, 
+    //  as does a user curve drawn from it
+    if ((state.velocityCurve == CurveInverse) || 
+        ((state.velocityCurve == CurveUser) && (state.userCurveInverse))) {
+      sustainTable[v] = (int64)(maxSustain * 127.0) / velocity;
+    }
+    else {
+      sustainTable[v] = (int64)(maxSustain * level);
+    }
+  }
+}
+
 // update the state of the guitar from sysex data
-GuitarState StanginAudioProcessor::updateGuitarState(GuitarState state, int sample, const uint8_t *data, int dataSize) {
+GuitarState StanginAudioProcessor::updateGuitarState(GuitarState state, int64 time, const uint8_t *data, int dataSize) {
+  TRACE_SCOPE("updateGuitarState");
   uint8_t type, fret, byte;
   // get the shortest number of samples between plays of the same note
-  int minAge = (int)(0.050 * getSampleRate());
+  int64 minAge = (int64)(0.050 * getSampleRate());
   // see what type of event we're handling
   type = data[3];
   // get the current string
   uint8_t i = (dataSize >= 5) ? (data[4] - 1) % 6 : 0;
   StringState &string = state.string[i];
+  int64 age = time - string.noteTime;
   // keepalive events, ignore
   if (type == 0x09) { }
   // changes to the fret state
@@ -107,37 +318,38 @@ GuitarState StanginAudioProcessor::updateGuitarState(GuitarState state, int samp
     }
     // if the fret changes to open, stop the note
     if ((state.dampOpen) && (string.fret > 0) && (fret == 0) && 
-        (string.age >= minAge)) {
-      string.samplesLeft = 0;
+        (age >= minAge)) {
+      string.endTime = time;
     }
     // enable tap mode
     else if ((state.tap) && (string.fret != fret)) {
       string.velocity = 127;
-      string.samplesLeft = string.samplesSustain = 
-        (int)(state.sustain * getSampleRate());
+      string.samplesSustain = (int64)(state.sustain * getSampleRate());
+      string.endTime = time + string.samplesSustain;
     }
     // enable/disable hammer-on
     if ((! state.hammeron) && (fret > string.fret)) {
-      string.samplesLeft = 0;
+      string.endTime = time;
     }
     // enable/disable pull-off
     else if ((! state.pulloff) && (fret < string.fret)) {
-      string.samplesLeft = 0;
+      string.endTime = time;
     }
     // update the string
-    if ((string.fret != fret) || (string.age >= minAge)) {
+    if ((string.fret != fret) || (age >= minAge)) {
       string.fret = fret;
-      string.sample = sample;
+      string.changeTime = time;
     }
     state.dirty = true;
   }
   // picking events
   else if ((type == 0x05) && (dataSize >= 6)) {
-    string.velocity = data[5];
-    if (string.age >= minAge) {
-      string.sample = sample;
-      string.samplesLeft = string.samplesSustain = 
-        (int)(state.sustain * getSampleRate() * 127.0) / string.velocity;
+    byte = data[5] & 0x7F;
+    string.velocity = velocityTable[byte];
+    if (age >= minAge) {
+      string.changeTime = time;
+      string.samplesSustain = sustainTable[byte];
+      string.endTime = time + string.samplesSustain;
     }
     state.dirty = true;
   }
@@ -164,76 +376,168 @@ GuitarState StanginAudioProcessor::updateGuitarState(GuitarState state, int samp
     // handle changes to button state
     for (int button = 0; button < ButtonCount; button++) {
       if (state.button[button] != oldState.button[button]) {
-        state = onButton(state, (ButtonIndex)button, sample);
+        state = onButton(state, (ButtonIndex)button, time);
       }
     }
   }
   // report unhandled sysex events
   else {
-    DBG(String::formatted("UNHANDLED SYSEX: %s", String::toHexString(data, dataSize)));
+    eventLog.write(LogUnhandledSysex, time, data, dataSize);
   }
   return(state);
 }
 
 // send note events to reflect a change in state and return the new state
 GuitarState StanginAudioProcessor::sendNotes(GuitarState oldState, GuitarState newState, MidiBuffer &output) {
-  int i, channel, note;
+  TRACE_SCOPE("sendNotes");
+  int i, note;
   // handle changes to string state
   for (i = 0; i < 6; i++) {
     StringState &oldString = oldState.string[i];
     StringState &newString = newState.string[i];
-    if (newString.sample < 0) continue;
-    channel = i + 1;
+    int64 time = newString.changeTime;
+    if (time < 0) continue;
     // update the string's note
     note = newString.openNote + newString.fret + newState.detune;
     // bounds check
     if ((note >= 0) && (note <= 127)) {
-      newString.note = note;
       // stop the string's current note if it's playing
-      if (oldString.samplesLeft > 0) {
-        output.addEvent(MidiMessage::noteOff(channel, oldString.note, newString.velocity), 
-                        newString.sample);
+      if (newString.note >= 0) {
+        sendNoteOff(i, newString.note, newString.velocity, time, output);
+        newString.note = -1;
       }
       // start the string's new note
-      if (newString.samplesLeft > 0) {
-        output.addEvent(MidiMessage::noteOn(channel, newString.note, newString.velocity), 
-                        newString.sample);
-        if (newString.note != oldString.note) newString.age = 0;
+      if (newString.endTime > time) {
+        stealVoice(newState, i, time, output);
+        sendNoteOn(i, note, newString.velocity, time, output);
+        if (monitoring) synth.pluck(i, note, newString.velocity, newString.endTime - time);
+        if (! offline) writeTabEvent(i, newString.fret, newString.velocity, time);
+        if (note != oldString.note) newString.noteTime = time;
+        newString.note = note;
       }
     }
-    newString.sample = -1;
+    else {
+      uint8_t info[3] = { (uint8_t)i, (uint8_t)(note & 0xFF), (uint8_t)((note >> 8) & 0xFF) };
+      eventLog.write(LogNoteOutOfRange, time, info, 3);
+    }
+    newString.changeTime = -1;
   }
   newState.dirty = false;
   return(newState);
 }
 
+// stop sounding strings until another can start within the polyphony limit
+void StanginAudioProcessor::stealVoice(GuitarState &state, int newString, int64 time, MidiBuffer &output) {
+  int i, sounding, victim;
+  int polyphony = jlimit(1, 6, state.polyphony);
+  while (true) {
+    sounding = 0;
+    victim = -1;
+    for (i = 0; i < 6; i++) {
+      StringState &string = state.string[i];
+      if ((i == newString) || (string.note < 0)) continue;
+      sounding++;
+      if (victim < 0) victim = i;
+      else if (state.stealPolicy == StealQuietest) {
+        if (string.endTime < state.string[victim].endTime) victim = i;
+      }
+      else if (state.stealPolicy == StealLowest) {
+        victim = i;
+      }
+      else {
+        if (string.noteTime < state.string[victim].noteTime) victim = i;
+      }
+    }
+    if (sounding < polyphony) return;
+    StringState &string = state.string[victim];
+    sendNoteOff(victim, string.note, string.velocity, time, output);
+    string.note = -1;
+    string.endTime = time;
+    ++stolenVoices;
+  }
+}
+
+// send MIDI note events for a string, checking that they pair up in debug builds
+void StanginAudioProcessor::sendNoteOn(int string, int note, uint8_t velocity, int64 time, MidiBuffer &output) {
+#if JUCE_DEBUG
+  jassert(soundingNote[string] < 0);
+  soundingNote[string] = note;
+#endif
+  output.addEvent(MidiMessage::noteOn(string + 1, note, velocity), getBlockSample(time));
+}
+void StanginAudioProcessor::sendNoteOff(int string, int note, uint8_t velocity, int64 time, MidiBuffer &output) {
+#if JUCE_DEBUG
+  jassert(soundingNote[string] == note);
+  soundingNote[string] = -1;
+#endif
+  output.addEvent(MidiMessage::noteOff(string + 1, note, velocity), getBlockSample(time));
+  if (monitoring) synth.damp(string);
+}
+
+// queue a note event for display, dropping it if the editor isn't keeping up
+void StanginAudioProcessor::writeTabEvent(int string, int fret, uint8_t velocity, int64 time) {
+  int start1, size1, start2, size2;
+  sharedState.addEvent(time, string, fret, velocity);
+  tabFifo.prepareToWrite(1, start1, size1, start2, size2);
+  if (size1 < 1) return;
+  TabEvent &event = tabEvents[start1];
+  event.time = time;
+  event.string = (uint8_t)string;
+  event.fret = (uint8_t)fret;
+  event.velocity = velocity;
+  tabFifo.finishedWrite(1);
+}
+
+// publish the guitar state to shared memory
+void StanginAudioProcessor::publishState(int64 time) {
+  TRACE_SCOPE("publishState");
+  SharedGuitarState *shared = sharedState.beginWrite();
+  if (shared == nullptr) return;
+  shared->sampleRate = getSampleRate();
+  shared->samplePosition = time;
+  shared->detune = guitar.detune;
+  shared->sustain = (float)guitar.sustain;
+  shared->stolenVoices = (uint32_t)stolenVoices.get();
+  for (int i = 0; i < 6; i++) {
+    const StringState &string = guitar.string[i];
+    SharedString &sharedString = shared->string[i];
+    sharedString.openNote = string.openNote;
+    sharedString.fret = string.fret;
+    sharedString.note = string.note;
+    sharedString.velocity = string.velocity;
+    sharedString.samplesLeft = jmax((int64)0, string.endTime - time);
+    // the shared layout has 32 bits for this, which is over 3 hours at 192 kHz
+    sharedString.samplesSustain = (int32_t)jmin(string.samplesSustain, 
+      (int64)std::numeric_limits<int32_t>::max());
+  }
+  sharedState.endWrite();
+}
+
+// read queued note events (called from the editor)
+int StanginAudioProcessor::readTabEvents(TabEvent *events, int maxEvents) {
+  int i, start1, size1, start2, size2;
+  tabFifo.prepareToRead(maxEvents, start1, size1, start2, size2);
+  for (i = 0; i < size1; i++) events[i] = tabEvents[start1 + i];
+  for (i = 0; i < size2; i++) events[size1 + i] = tabEvents[start2 + i];
+  tabFifo.finishedRead(size1 + size2);
+  return(size1 + size2);
+}
+
 // update the guitar state and send events to reflect the passing of time
-GuitarState StanginAudioProcessor::ageGuitarState(GuitarState state, int startSample, int endSample, MidiBuffer &output) {
-  int i, channel;
-  // get the time elapsed since the last event
-  int elapsed = endSample - startSample;
-  if (elapsed < 0) elapsed = 0;
-  // age strings
+GuitarState StanginAudioProcessor::ageGuitarState(GuitarState state, int64 startTime, int64 endTime, MidiBuffer &output) {
+  TRACE_SCOPE("ageGuitarState");
+  int i;
+  // stop strings that have run out of sustain
   for (i = 0; i < 6; i++) {
     StringState &string = state.string[i];
-    string.age += elapsed;
-    if (string.samplesLeft <= elapsed) {
-      if (string.note >= 0) {
-        channel = i + 1;
-        output.addEvent(MidiMessage::noteOff(channel, string.note, string.velocity), 
-                        startSample + string.samplesLeft);
-        string.note = -1;
-      }
-      string.samplesLeft = 0;
-    }
-    else {
-      string.samplesLeft -= elapsed;
+    if ((string.note >= 0) && (string.endTime <= endTime)) {
+      sendNoteOff(i, string.note, string.velocity, 
+                  jmax(startTime, string.endTime), output);
+      string.note = -1;
     }
   }
-  // age button presses
-  timePressingButton += elapsed;
-  int buttonRate = (int)(getSampleRate() * 0.05f);
-  if (timePressingButton >= buttonRate) {
+  // repeat the actions of held buttons
+  if (endTime >= buttonRepeatTime) {
     if ((state.button[ButtonTriangle]) && (state.sustain > minSustain)) {
       state.sustain -= sustainIncrement;
       if (state.sustain < minSustain) state.sustain = minSustain;
@@ -242,17 +546,32 @@ GuitarState StanginAudioProcessor::ageGuitarState(GuitarState state, int startSa
       if (state.sustain <= minSustain) state.sustain = 0.0f;
       state.sustain += sustainIncrement;
     }
-    timePressingButton = 0;
+    buttonRepeatTime = endTime + (int64)(getSampleRate() * 0.05f);
   }
   return(state);
 }
 
-GuitarState StanginAudioProcessor::onButton(GuitarState oldState, ButtonIndex button, int sample) {
+int64 StanginAudioProcessor::getAgeDeadline(const GuitarState &state) {
+  // only the sustain buttons repeat while held
+  int64 deadline = std::numeric_limits<int64>::max();
+  if ((state.button[ButtonTriangle]) || (state.button[ButtonX])) {
+    deadline = buttonRepeatTime;
+  }
+  for (int i = 0; i < 6; i++) {
+    const StringState &string = state.string[i];
+    if ((string.note >= 0) && (string.endTime < deadline)) {
+      deadline = string.endTime;
+    }
+  }
+  return(deadline);
+}
+
+GuitarState StanginAudioProcessor::onButton(GuitarState oldState, ButtonIndex button, int64 time) {
   int i;
   GuitarState newState = oldState;
   bool pressed = newState.button[button];
   // require the button to be held a bit before it starts repeating
-  if (pressed) timePressingButton = - (int)(0.1f * getSampleRate());
+  if (pressed) buttonRepeatTime = time + (int64)(0.15f * getSampleRate());
   switch (button) {
     case ButtonSquare:
       if (pressed) {
@@ -285,8 +604,8 @@ GuitarState StanginAudioProcessor::onButton(GuitarState oldState, ButtonIndex bu
       // damp all strings
       if (pressed) {
         for (i = 0; i < 6; i++) {
-          newState.string[i].samplesLeft = 0;
-          newState.string[i].sample = sample;
+          newState.string[i].endTime = time;
+          newState.string[i].changeTime = time;
         }
       }
       newState.dirty = true;
@@ -309,8 +628,8 @@ GuitarState StanginAudioProcessor::onButton(GuitarState oldState, ButtonIndex bu
   // adjust detune
   if (newState.detune != oldState.detune) {
     for (i = 0; i < 6; i++) {
-      if (newState.string[i].samplesLeft > 0) {
-        newState.string[i].sample = sample;
+      if (newState.string[i].endTime > time) {
+        newState.string[i].changeTime = time;
       }
     }
   }
@@ -319,14 +638,104 @@ GuitarState StanginAudioProcessor::onButton(GuitarState oldState, ButtonIndex bu
 
 // STATE **********************************************************************
 
+// saved state starts with a tag and a version number, and fields are read back 
+//  one at a time so that versions can add fields without losing older sessions
+static const int stateTag = 0x676e7453; // "Stng"
+static const int stateVersion = 2;
+
+// the layout of the guitar state that was saved before it was versioned
+typedef struct {
+  struct {
+    uint8_t openNote;
+    int fret;
+    uint8_t velocity;
+    int samplesLeft;
+    int samplesSustain;
+    int age;
+    int note;
+    int sample;
+  } string[6];
+  bool button[ButtonCount];
+  int detune;
+  double sustain;
+  bool hammeron;
+  bool pulloff;
+  bool dampOpen;
+  bool tap;
+  bool dirty;
+} LegacyGuitarState;
+
 void StanginAudioProcessor::getStateInformation (MemoryBlock& destData) {
-  destData.replaceWith((void *)(&guitar), sizeof(GuitarState));
+  MemoryOutputStream out(destData, false);
+  out.writeInt(stateTag);
+  out.writeInt(stateVersion);
+  for (int i = 0; i < 6; i++) out.writeByte((char)guitar.string[i].openNote);
+  out.writeInt(guitar.detune);
+  out.writeDouble(guitar.sustain);
+  out.writeBool(guitar.hammeron);
+  out.writeBool(guitar.pulloff);
+  out.writeBool(guitar.dampOpen);
+  out.writeBool(guitar.tap);
+  out.writeInt(guitar.velocityCurve);
+  out.write(guitar.userCurve, sizeof(guitar.userCurve));
+  out.writeInt(guitar.polyphony);
+  out.writeInt(guitar.stealPolicy);
+  out.writeDouble(guitar.reconcileWindow);
+  out.writeBool(guitar.monitor);
+  out.writeInt(guitar.passthrough);
+  out.writeInt(guitar.passthroughChannel);
+  // added in version 2
+  out.writeBool(guitar.userCurveInverse);
 }
 
 void StanginAudioProcessor::setStateInformation (const void* data, int sizeInBytes) {
-  if (sizeInBytes == sizeof(GuitarState)) {
-    guitar = *((GuitarState *)data);
+  int i;
+  GuitarState state = guitar;
+  MemoryInputStream in(data, (size_t)jmax(0, sizeInBytes), false);
+  if ((sizeInBytes >= 8) && (in.readInt() == stateTag)) {
+    // fields from newer versions than this one are ignored
+    int version = in.readInt();
+    if (version < 1) return;
+    for (i = 0; i < 6; i++) state.string[i].openNote = (uint8_t)in.readByte();
+    state.detune = in.readInt();
+    state.sustain = in.readDouble();
+    state.hammeron = in.readBool();
+    state.pulloff = in.readBool();
+    state.dampOpen = in.readBool();
+    state.tap = in.readBool();
+    state.velocityCurve = in.readInt();
+    in.read(state.userCurve, sizeof(state.userCurve));
+    state.polyphony = in.readInt();
+    state.stealPolicy = in.readInt();
+    state.reconcileWindow = in.readDouble();
+    state.monitor = in.readBool();
+    state.passthrough = in.readInt();
+    state.passthroughChannel = in.readInt();
+    if (version >= 2) state.userCurveInverse = in.readBool();
   }
+  // accept sessions saved before the state was versioned
+  else if (sizeInBytes == sizeof(LegacyGuitarState)) {
+    const LegacyGuitarState *legacy = (const LegacyGuitarState *)data;
+    for (i = 0; i < 6; i++) state.string[i].openNote = legacy->string[i].openNote;
+    state.detune = legacy->detune;
+    state.sustain = legacy->sustain;
+    state.hammeron = legacy->hammeron;
+    state.pulloff = legacy->pulloff;
+    state.dampOpen = legacy->dampOpen;
+    state.tap = legacy->tap;
+  }
+  else return;
+  // keep settings in range in case the data is damaged
+  state.sustain = jlimit((double)minSustain, (double)maxSustain, state.sustain);
+  state.velocityCurve = jlimit(0, CurveCount - 1, state.velocityCurve);
+  for (i = 0; i < 128; i++) state.userCurve[i] &= 0x7F;
+  state.polyphony = jlimit(1, 6, state.polyphony);
+  state.stealPolicy = jlimit(0, StealPolicyCount - 1, state.stealPolicy);
+  state.reconcileWindow = jlimit(0.0, (double)maxReconcileWindow, state.reconcileWindow);
+  state.passthrough &= PassAll;
+  state.passthroughChannel = jlimit(0, 16, state.passthroughChannel);
+  guitar = state;
+  updateLatency();
 }
 
 // SETUP ***********************************************************************
@@ -339,7 +748,10 @@ bool StanginAudioProcessor::acceptsMidi() const { return true; }
 
 bool StanginAudioProcessor::producesMidi() const { return true; }
 
-double StanginAudioProcessor::getTailLengthSeconds() const { return(0.0); }
+// the monitor synth keeps sounding for a while after its last note ends
+double StanginAudioProcessor::getTailLengthSeconds() const { 
+  return(guitar.monitor ? SYNTH_TAIL_SECONDS : 0.0);
+}
 
 int StanginAudioProcessor::getNumPrograms() {
   return(1);
@@ -361,7 +773,9 @@ void StanginAudioProcessor::changeProgramName (int index, const String& newName)
 
 bool StanginAudioProcessor::setPreferredBusArrangement (bool isInput, int bus, const AudioChannelSet& preferredSet) {
   const int numChannels = preferredSet.size();
-  if (numChannels != 0) return false;
+  // there's no audio input, and the output is only for the monitor synth
+  if ((isInput) && (numChannels != 0)) return false;
+  if (numChannels > 2) return false;
   return AudioProcessor::setPreferredBusArrangement (isInput, bus, preferredSet);
 }
 
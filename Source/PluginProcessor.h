@@ -1,18 +1,25 @@
 #ifndef PLUGINPROCESSOR_H_INCLUDED
 #define PLUGINPROCESSOR_H_INCLUDED
 
-#include "../JuceLibraryCode/JuceHeader.h"
-
-// string state
+// JuceHeader.h is found on each project's include path rather than next to 
+//  these sources, so the tools that build them get their own configuration
+#include "JuceHeader.h"
+#include "EventLog.h"
+#include "SharedState.h"
+#include "StringSynth.h"
+#include "Trace.h"
+#include "Tunings.h"
+
+// string state (all times are absolute sample times)
 typedef struct {
   uint8_t openNote; // the note the string has when fret = 0
   int fret = 0; // the current fret number on the string
   uint8_t velocity = 0; // the velocity of the last pluck
-  int samplesLeft = 0; // samples before the string stops sounding
-  int samplesSustain = 0; // the number of samples left after last pluck
-  int age = 0; // samples since the last note change
-  int note = -1; // the last MIDI note number of the string
-  int sample = -1; // the sample when the string state was last changed
+  int64 endTime = 0; // the time when the string stops sounding
+  int64 samplesSustain = 0; // the number of samples left after last pluck
+  int64 noteTime = 0; // the time of the last note change
+  int note = -1; // the MIDI note the string is sounding, or -1 if silent
+  int64 changeTime = -1; // the time the string state was last changed
 } StringState;
 
 // button indices
@@ -32,6 +39,34 @@ typedef enum {
   ButtonCount // (not a real button)
 } ButtonIndex;
 
+// classes of MIDI messages that can be passed through from the input
+typedef enum {
+  PassNotes       = 0x01, // note on/off and polyphonic aftertouch
+  PassControllers = 0x02, // control changes
+  PassPrograms    = 0x04, // program changes
+  PassPressure    = 0x08, // channel aftertouch
+  PassPitchBend   = 0x10, // pitch bend
+  PassSystem      = 0x20, // clock, transport, and other non-sysex system messages
+  PassAll         = 0x3F
+} PassthroughClass;
+
+// curves mapping pick velocity to output velocity and sustain
+typedef enum {
+  CurveLinear = 0, // velocity and sustain rise in proportion to the pick
+  CurveInverse, // velocity follows the pick, softer picks sustain longer
+  CurveExponential, // velocity and sustain rise slowly, then quickly
+  CurveUser, // velocity and sustain follow a user-drawn curve
+  CurveCount // (not a real curve)
+} VelocityCurve;
+
+// ways to choose which string to stop when too many are sounding
+typedef enum {
+  StealOldest = 0, // stop the string that started sounding first
+  StealQuietest, // stop the string with the least sustain remaining
+  StealLowest, // stop the lowest-pitched string
+  StealPolicyCount // (not a real policy)
+} StealPolicy;
+
 // instrument state
 typedef struct {
   StringState string[6]; // string 0 has the highest pitch
@@ -42,9 +77,26 @@ typedef struct {
   bool pulloff = true; // whether to allow the note to fall while sounding
   bool dampOpen = true; // whether to damp the string when it becomes open
   bool tap = false; // whether to start notes when frets are pressed
+  int velocityCurve = CurveInverse; // the curve to map pick velocity with
+  uint8_t userCurve[128]; // output velocities for each pick velocity
+  bool userCurveInverse = false; // whether the user curve sustains softer output longer
+  int polyphony = 6; // the most strings allowed to sound at once
+  int stealPolicy = StealOldest; // how to choose strings to stop (see StealPolicy)
+  double reconcileWindow = 0.0; // seconds to hold picks for a matching fret change
+  bool monitor = false; // whether to play the built-in synth on the audio output
+  int passthrough = 0; // a mask of message classes to merge from the input
+  int passthroughChannel = 0; // the channel to move merged messages to (0 to keep)
   bool dirty = false; // whether any state has changed
 } GuitarState;
 
+// a decoded note event for the tablature display
+typedef struct {
+  int64 time; // the absolute sample time of the event
+  uint8_t string; // the index of the string that sounded
+  uint8_t fret; // the fret the string was played at
+  uint8_t velocity; // the velocity of the pick
+} TabEvent;
+
 class StanginAudioProcessor  : public AudioProcessor {
   public:
     StanginAudioProcessor();
@@ -80,15 +132,107 @@ class StanginAudioProcessor  : public AudioProcessor {
     float sustainIncrement = 0.1f;
     float minSustain = 0.01f;
     float maxSustain = 10.0f;
+    
+    float maxReconcileWindow = 0.02f;
+    // tell the host the latency of the reconciliation window (message thread only)
+    void updateLatency();
+    
+    // the absolute sample time at the end of the last processed block
+    Atomic<int64> samplePosition;
+    // read decoded note events into an array, returning the number read
+    int readTabEvents(TabEvent *events, int maxEvents);
+    
+    // built-in and user tunings, shared by all instances
+    SharedResourcePointer<TuningLibrary> tuningLibrary;
+    
+    // the number of notes stopped early to stay within the polyphony limit
+    Atomic<int> stolenVoices;
+    
+    // get the output level (0-1) for a pick velocity under the current curve
+    static double getCurveLevel(const GuitarState &state, int velocity);
 
   protected:
-    int timePressingButton = 0;
+    int64 buttonRepeatTime = 0; // the time to repeat held button actions
+    int64 blockStart = 0; // the time of the first sample in the current block
+    
+    int64 lastTime = 0; // the time the guitar state was last updated
+    bool monitoring = false; // whether the monitor synth is playing this block
+    bool offline = false; // whether the host is rendering faster than realtime
+    
+    // convert an absolute time to a sample offset in the current block
+    int getBlockSample(int64 time) { return((int)(time - blockStart)); }
+    
+    // handle a MIDI message at the given time
+    void processMessage(const uint8_t *data, int dataSize, int64 time, 
+                        AudioSampleBuffer &buffer, MidiBuffer &output);
+    
+    // the longest message handled, which is about twice as long as any the 
+    //  controller sends
+    static const int maxMessageSize = 16;
+    
+    // messages held during the reconciliation window, in time order
+    typedef struct {
+      int64 time; // the time to handle the message at
+      int size; // the number of bytes of data
+      uint8_t data[maxMessageSize]; // the message, including any sysex start and end bytes
+      bool consumed; // whether the message was handled early
+    } QueuedMessage;
+    static const int messageQueueSize = 512;
+    QueuedMessage queue[messageQueueSize];
+    int queueStart = 0;
+    int queueCount = 0;
+    int queueWindow = 0; // the window in samples that held messages were timed for
+    void queueMessage(const uint8_t *data, int dataSize, int64 time);
+    void processQueue(int64 endTime, AudioSampleBuffer &buffer, MidiBuffer &output);
+    QueuedMessage *findFretChange(uint8_t string, int64 endTime);
+    
+    // a lock-free queue of decoded note events for the editor
+    static const int tabFifoSize = 1024;
+    AbstractFifo tabFifo;
+    TabEvent tabEvents[tabFifoSize];
+    void writeTabEvent(int string, int fret, uint8_t velocity, int64 time);
+    
+    // a shared memory segment for external displays to read state from
+    SharedStatePublisher sharedState;
+    void publishState(int64 time);
+    
+    // a plucked string synth to monitor the output with
+    StringSynth synth;
+    
+    // a log of engine anomalies that's safe to write from the audio thread
+    EventLog eventLog;
+    
+    #if STANGIN_TRACE
+    // writes trace markers to disk while any instance is open
+    SharedResourcePointer<TraceExporter> traceExporter;
+    #endif
+    
+    // output velocity and sustain samples for each pick velocity
+    uint8_t velocityTable[128];
+    int64 sustainTable[128];
+    // the settings the tables were last built for
+    int tableCurve = -1;
+    double tableSustain = -1.0;
+    double tableSampleRate = -1.0;
+    uint8_t tableUserCurve[128];
+    bool tableUserCurveInverse = false;
+    void updateCurveTables(const GuitarState &state);
     
     GuitarState resetState(GuitarState state);
-    GuitarState updateGuitarState(GuitarState state, int sample, const uint8_t *data, int dataSize);
+    GuitarState updateGuitarState(GuitarState state, int64 time, const uint8_t *data, int dataSize);
     GuitarState sendNotes(GuitarState oldState, GuitarState newState, MidiBuffer &output);
-    GuitarState ageGuitarState(GuitarState state, int startSample, int endSample, MidiBuffer &output);
-    GuitarState onButton(GuitarState state, ButtonIndex button, int sample);
+    GuitarState ageGuitarState(GuitarState state, int64 startTime, int64 endTime, MidiBuffer &output);
+    // get the earliest time at which aging can change the state
+    int64 getAgeDeadline(const GuitarState &state);
+    GuitarState onButton(GuitarState state, ButtonIndex button, int64 time);
+    void stealVoice(GuitarState &state, int newString, int64 time, MidiBuffer &output);
+    void sendNoteOn(int string, int note, uint8_t velocity, int64 time, MidiBuffer &output);
+    void sendNoteOff(int string, int note, uint8_t velocity, int64 time, MidiBuffer &output);
+#if JUCE_DEBUG
+    int soundingNote[6] = { -1, -1, -1, -1, -1, -1 }; // notes sent, for checking
+#endif
+    int getPassthroughClass(uint8_t status);
+    void passMessage(const uint8_t *data, int dataSize, int sample, MidiBuffer &output);
 
   private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StanginAudioProcessor)
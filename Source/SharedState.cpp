@@ -0,0 +1,110 @@
+#include "SharedState.h"
+
+#if JUCE_LINUX || JUCE_MAC
+  #include <errno.h>
+  #include <fcntl.h>
+  #include <signal.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+  #define STANGIN_SHARED_STATE 1
+#endif
+
+SharedStatePublisher::SharedStatePublisher() {
+  // take the first segment that isn't in use by a running process
+  for (int i = 0; i < STANGIN_SHM_MAX_SEGMENTS; i++) {
+    if (open(String(STANGIN_SHM_PREFIX) + String(i))) break;
+  }
+}
+
+SharedStatePublisher::~SharedStatePublisher() {
+#if STANGIN_SHARED_STATE
+  if (shared != nullptr) {
+    munmap(shared, sizeof(SharedGuitarState));
+    shm_unlink(name.toRawUTF8());
+  }
+#endif
+}
+
+bool SharedStatePublisher::open(const String &segmentName) {
+#if STANGIN_SHARED_STATE
+  const char *path = segmentName.toRawUTF8();
+  int fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+  // reclaim segments left behind by processes that have exited
+  if ((fd < 0) && (errno == EEXIST)) {
+    int oldFd = shm_open(path, O_RDONLY, 0);
+    if (oldFd < 0) return(false);
+    struct stat info;
+    int32_t pid = 0;
+    if ((fstat(oldFd, &info) == 0) && 
+        (info.st_size >= (off_t)sizeof(SharedGuitarState))) {
+      void *old = mmap(nullptr, sizeof(SharedGuitarState), PROT_READ, MAP_SHARED, oldFd, 0);
+      if (old != MAP_FAILED) {
+        pid = ((SharedGuitarState *)old)->pid;
+        munmap(old, sizeof(SharedGuitarState));
+      }
+    }
+    close(oldFd);
+    if ((pid > 0) && ((kill(pid, 0) == 0) || (errno != ESRCH))) return(false);
+    shm_unlink(path);
+    fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+  }
+  if (fd < 0) return(false);
+  if (ftruncate(fd, sizeof(SharedGuitarState)) != 0) {
+    close(fd);
+    shm_unlink(path);
+    return(false);
+  }
+  void *mapped = mmap(nullptr, sizeof(SharedGuitarState), 
+                      PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    shm_unlink(path);
+    return(false);
+  }
+  // the segment starts zeroed, so only the header needs filling in
+  shared = (SharedGuitarState *)mapped;
+  shared->size = sizeof(SharedGuitarState);
+  shared->version = STANGIN_SHM_VERSION;
+  shared->pid = (int32_t)getpid();
+  shared->sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  shared->magic = STANGIN_SHM_MAGIC;
+  name = segmentName;
+  return(true);
+#else
+  return(false);
+#endif
+}
+
+// AUDIO THREAD ***************************************************************
+
+void SharedStatePublisher::addEvent(int64 time, int string, int fret, uint8_t velocity) {
+  if ((shared == nullptr) || (pendingEventCount >= maxPendingEvents)) return;
+  SharedEvent &event = pendingEvents[pendingEventCount++];
+  event.time = time;
+  event.string = (uint8_t)string;
+  event.fret = (uint8_t)fret;
+  event.velocity = velocity;
+}
+
+SharedGuitarState *SharedStatePublisher::beginWrite() {
+  if (shared == nullptr) return(nullptr);
+  // mark the segment as being written
+  uint32_t sequence = shared->sequence.load(std::memory_order_relaxed);
+  shared->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  return(shared);
+}
+
+void SharedStatePublisher::endWrite() {
+  if (shared == nullptr) return;
+  for (int i = 0; i < pendingEventCount; i++) {
+    shared->event[shared->eventCount % STANGIN_SHM_EVENTS] = pendingEvents[i];
+    shared->eventCount++;
+  }
+  pendingEventCount = 0;
+  // mark the segment as consistent
+  uint32_t sequence = shared->sequence.load(std::memory_order_relaxed);
+  shared->sequence.store(sequence + 1, std::memory_order_release);
+}
@@ -0,0 +1,38 @@
+#ifndef SHAREDSTATE_H_INCLUDED
+#define SHAREDSTATE_H_INCLUDED
+
+#include "JuceHeader.h"
+#include "SharedStateLayout.h"
+
+// publishes guitar state to a shared memory segment for external readers
+class SharedStatePublisher {
+  public:
+    SharedStatePublisher();
+    ~SharedStatePublisher();
+    
+    // get the name of the segment, or an empty string if it couldn't be made
+    const String &getName() const { return(name); }
+    
+    // queue a note event to publish with the next update
+    void addEvent(int64 time, int string, int fret, uint8_t velocity);
+    // start updating the segment, returning nullptr if there's no segment
+    SharedGuitarState *beginWrite();
+    // publish queued events and finish updating the segment
+    void endWrite();
+
+  protected:
+    String name;
+    SharedGuitarState *shared = nullptr;
+    
+    // events waiting to be published
+    static const int maxPendingEvents = 64;
+    SharedEvent pendingEvents[maxPendingEvents];
+    int pendingEventCount = 0;
+    
+    bool open(const String &segmentName);
+
+  private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedStatePublisher)
+};
+
+#endif  // SHAREDSTATE_H_INCLUDED
@@ -0,0 +1,70 @@
+#ifndef SHAREDSTATELAYOUT_H_INCLUDED
+#define SHAREDSTATELAYOUT_H_INCLUDED
+
+// The layout of the shared memory segment Stangin publishes its state to.
+// This header has no dependencies beyond the C++11 standard library so that
+//  external tools can include it directly.
+//
+// The segment is written by the audio thread once per block and can be read
+//  by any number of processes. Readers should retry until they see the same 
+//  even sequence number before and after copying what they need:
+//
+//    do {
+//      s1 = shared->sequence.load(std::memory_order_acquire);
+//      ...copy fields...
+//      std::atomic_thread_fence(std::memory_order_acquire);
+//      s2 = shared->sequence.load(std::memory_order_relaxed);
+//    } while ((s1 & 1) || (s1 != s2));
+
+#include <stdint.h>
+#include <atomic>
+
+// segments are named with this prefix and a number (e.g. "/stangin-0")
+#define STANGIN_SHM_PREFIX "/stangin-"
+// the maximum number of segments (and so plugin instances) to publish
+#define STANGIN_SHM_MAX_SEGMENTS 16
+// identifies the segment and its layout
+#define STANGIN_SHM_MAGIC 0x474E5453 // "STNG"
+#define STANGIN_SHM_VERSION 1
+// the number of recent note events kept in the segment
+#define STANGIN_SHM_EVENTS 256
+
+// the state of one string
+typedef struct {
+  int32_t openNote; // the note the string has when fret = 0
+  int32_t fret; // the current fret number on the string
+  int32_t note; // the MIDI note the string is sounding, or -1 if silent
+  int32_t velocity; // the velocity of the last pluck
+  int64_t samplesLeft; // samples before the string stops sounding
+  int32_t samplesSustain; // the sustain length of the last pluck, in samples
+  int32_t reserved;
+} SharedString;
+
+// a decoded note event
+typedef struct {
+  int64_t time; // the absolute sample time of the event
+  uint8_t string; // the index of the string that sounded (0 has the highest pitch)
+  uint8_t fret; // the fret the string was played at
+  uint8_t velocity; // the velocity of the pick
+  uint8_t reserved[5];
+} SharedEvent;
+
+typedef struct {
+  uint32_t magic; // STANGIN_SHM_MAGIC
+  uint32_t version; // STANGIN_SHM_VERSION
+  uint32_t size; // sizeof(SharedGuitarState)
+  int32_t pid; // the process publishing to the segment
+  std::atomic<uint32_t> sequence; // odd while the segment is being written
+  uint32_t stolenVoices; // notes stopped early to stay within the polyphony limit
+  double sampleRate; // the sample rate of the timeline
+  int64_t samplePosition; // the absolute sample time at the end of the last block
+  int32_t detune; // number of semitones to adjust tuning on all strings
+  float sustain; // the maximum length of played notes in seconds
+  SharedString string[6]; // string 0 has the highest pitch
+  uint64_t eventCount; // the total number of events ever written
+  SharedEvent event[STANGIN_SHM_EVENTS]; // event n is at index n % STANGIN_SHM_EVENTS
+} SharedGuitarState;
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "shared state requires lock-free atomics");
+
+#endif  // SHAREDSTATELAYOUT_H_INCLUDED
@@ -0,0 +1,161 @@
+#include "StringSynth.h"
+#include "Trace.h"
+
+#if defined(__AVX__)
+  #include <immintrin.h>
+#elif defined(__SSE2__)
+  #include <emmintrin.h>
+#endif
+#if JUCE_INTEL
+  #include <xmmintrin.h>
+#endif
+
+// the loop gain of damped voices
+static const float dampFeedback = 0.9f;
+// the longest a voice can ring before being damped (exact in a float counter)
+static const int64 maxSamplesLeft = (1 << 24);
+// the lowest pitch the delay lines must hold, in Hz
+static const double minFrequency = 20.0;
+
+// the bits of the SSE control register that flush denormal results and 
+//  inputs to zero
+static const uint32 denormalFlushBits = 0x8040;
+
+ScopedDenormalFlush::ScopedDenormalFlush() {
+#if JUCE_INTEL
+  savedMode = _mm_getcsr();
+  _mm_setcsr(savedMode | denormalFlushBits);
+#endif
+}
+
+ScopedDenormalFlush::~ScopedDenormalFlush() {
+#if JUCE_INTEL
+  _mm_setcsr(savedMode);
+#endif
+}
+
+StringSynth::StringSynth() {
+  for (int i = 0; i < SYNTH_LANES; i++) {
+    length[i] = 1;
+    samplesLeft[i] = 0.0f;
+    feedback[i] = dampFeedback;
+    level[i] = 0.0f;
+  }
+}
+
+void StringSynth::prepare(double sampleRate) {
+  if ((sampleRate == rate) && (lines != nullptr)) return;
+  rate = sampleRate;
+  int size = 1;
+  while (size < (int)(sampleRate / minFrequency) + 2) size <<= 1;
+  lines.calloc((size_t)(size * SYNTH_LANES));
+  mask = size - 1;
+  writeIndex = 0;
+  idleSamples = 0;
+  for (int i = 0; i < SYNTH_LANES; i++) samplesLeft[i] = 0.0f;
+}
+
+// AUDIO THREAD ***************************************************************
+
+void StringSynth::pluck(int voice, int note, uint8_t velocity, int64 ringSamples) {
+  if ((voice < 0) || (voice >= SYNTH_LANES) || (lines == nullptr)) return;
+  double frequency = 440.0 * pow(2.0, (double)(note - 69) / 12.0);
+  // the averaging filter adds half a sample of delay to the loop
+  int delay = (int)((rate / frequency) - 0.5);
+  delay = jlimit(2, mask - 1, delay);
+  length[voice] = delay;
+  // lose about 60 dB over 4 seconds, whatever the pitch
+  feedback[voice] = (float)pow(0.001, (double)delay / (4.0 * rate));
+  samplesLeft[voice] = (float)jlimit((int64)0, maxSamplesLeft, ringSamples);
+  level[voice] = ((float)velocity / 127.0f) / 3.0f;
+  // fill the voice's delay line with noise
+  for (int i = 1; i <= delay + 1; i++) {
+    seed = (seed * 1664525u) + 1013904223u;
+    float noise = ((float)(seed >> 8) / (float)(1 << 23)) - 1.0f;
+    lines[(((writeIndex - i) & mask) * SYNTH_LANES) + voice] = noise;
+  }
+  idleSamples = 0;
+}
+
+void StringSynth::damp(int voice) {
+  if ((voice < 0) || (voice >= SYNTH_LANES)) return;
+  samplesLeft[voice] = 0.0f;
+}
+
+void StringSynth::reset() {
+  for (int i = 0; i < SYNTH_LANES; i++) samplesLeft[i] = 0.0f;
+  if (lines != nullptr) lines.clear((size_t)((mask + 1) * SYNTH_LANES));
+  idleSamples = (int)(rate * SYNTH_TAIL_SECONDS) + 1;
+}
+
+void StringSynth::render(AudioSampleBuffer &buffer, int startSample, int endSample) {
+  TRACE_SCOPE("renderSynth");
+  int i, t, channel;
+  int channels = buffer.getNumChannels();
+  if ((lines == nullptr) || (channels <= 0)) return;
+  startSample = jmax(0, startSample);
+  endSample = jmin(buffer.getNumSamples(), endSample);
+  float **channelData = buffer.getArrayOfWritePointers();
+  float a[SYNTH_LANES], b[SYNTH_LANES], y[SYNTH_LANES];
+  for (t = startSample; t < endSample; t++) {
+    // stop computing once damped voices have died away
+    if (idleSamples > (int)(rate * SYNTH_TAIL_SECONDS)) break;
+    // gather the two oldest samples of each voice's delay line
+    for (i = 0; i < SYNTH_LANES; i++) {
+      int r = (writeIndex - length[i]) & mask;
+      a[i] = lines[(r * SYNTH_LANES) + i];
+      b[i] = lines[(((r - 1) & mask) * SYNTH_LANES) + i];
+    }
+    float *w = lines + (writeIndex * SYNTH_LANES);
+    // average them and apply the loop gain, which drops once a voice's 
+    //  sustain has run out
+#if defined(__AVX__)
+    __m256 left = _mm256_loadu_ps(samplesLeft);
+    __m256 ringing = _mm256_cmp_ps(left, _mm256_setzero_ps(), _CMP_GT_OQ);
+    __m256 gain = _mm256_blendv_ps(_mm256_set1_ps(dampFeedback), 
+                                   _mm256_loadu_ps(feedback), ringing);
+    left = _mm256_max_ps(_mm256_sub_ps(left, _mm256_set1_ps(1.0f)), 
+                         _mm256_setzero_ps());
+    _mm256_storeu_ps(samplesLeft, left);
+    __m256 out = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(a), _mm256_loadu_ps(b)), 
+                               _mm256_mul_ps(gain, _mm256_set1_ps(0.5f)));
+    _mm256_storeu_ps(w, out);
+    _mm256_storeu_ps(y, _mm256_mul_ps(out, _mm256_loadu_ps(level)));
+    int anyRinging = _mm256_movemask_ps(ringing);
+#elif defined(__SSE2__)
+    int anyRinging = 0;
+    for (i = 0; i < SYNTH_LANES; i += 4) {
+      __m128 left = _mm_loadu_ps(samplesLeft + i);
+      __m128 ringing = _mm_cmpgt_ps(left, _mm_setzero_ps());
+      __m128 gain = _mm_or_ps(_mm_and_ps(ringing, _mm_loadu_ps(feedback + i)), 
+                              _mm_andnot_ps(ringing, _mm_set1_ps(dampFeedback)));
+      left = _mm_max_ps(_mm_sub_ps(left, _mm_set1_ps(1.0f)), _mm_setzero_ps());
+      _mm_storeu_ps(samplesLeft + i, left);
+      __m128 out = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)), 
+                              _mm_mul_ps(gain, _mm_set1_ps(0.5f)));
+      _mm_storeu_ps(w + i, out);
+      _mm_storeu_ps(y + i, _mm_mul_ps(out, _mm_loadu_ps(level + i)));
+      anyRinging |= _mm_movemask_ps(ringing);
+    }
+#else
+    int anyRinging = 0;
+    for (i = 0; i < SYNTH_LANES; i++) {
+      bool ringing = (samplesLeft[i] > 0.0f);
+      float gain = ringing ? feedback[i] : dampFeedback;
+      if (ringing) {
+        samplesLeft[i] -= 1.0f;
+        anyRinging = 1;
+      }
+      w[i] = (a[i] + b[i]) * 0.5f * gain;
+      y[i] = w[i] * level[i];
+    }
+#endif
+    writeIndex = (writeIndex + 1) & mask;
+    idleSamples = anyRinging ? 0 : idleSamples + 1;
+    // mix the voices to every output channel
+    float mix = ((y[0] + y[1]) + (y[2] + y[3])) + ((y[4] + y[5]) + (y[6] + y[7]));
+    for (channel = 0; channel < channels; channel++) {
+      channelData[channel][t] += mix;
+    }
+  }
+}
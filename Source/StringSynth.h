@@ -0,0 +1,59 @@
+#ifndef STRINGSYNTH_H_INCLUDED
+#define STRINGSYNTH_H_INCLUDED
+
+#include "JuceHeader.h"
+
+// the number of voices processed together (six strings padded to a vector)
+#define SYNTH_LANES 8
+// how long damped voices are rendered for before the synth goes quiet
+#define SYNTH_TAIL_SECONDS 1.0
+
+// flushes denormal numbers to zero while in scope, then restores the 
+//  thread's previous mode, which the host and other plugins may depend on
+class ScopedDenormalFlush {
+  public:
+    ScopedDenormalFlush();
+    ~ScopedDenormalFlush();
+  private:
+    uint32 savedMode = 0;
+};
+
+// a six-voice Karplus-Strong plucked string synth for monitoring, with each 
+//  step of the delay-line kernel computed for all voices at once
+class StringSynth {
+  public:
+    StringSynth();
+    
+    // allocate delay lines for the given sample rate (not realtime safe)
+    void prepare(double sampleRate);
+    
+    // pluck a voice, letting it ring freely for the given number of samples
+    void pluck(int voice, int note, uint8_t velocity, int64 samplesLeft);
+    // damp a voice so that it dies away quickly
+    void damp(int voice);
+    // silence all voices at once
+    void reset();
+    
+    // add the sound of all voices to the buffer between the given samples, 
+    //  which should be done with denormals flushed (see ScopedDenormalFlush)
+    void render(AudioSampleBuffer &buffer, int startSample, int endSample);
+
+  protected:
+    double rate = 0.0;
+    HeapBlock<float> lines; // interleaved delay lines, SYNTH_LANES per step
+    int mask = 0; // the length of each delay line minus one
+    int writeIndex = 0; // the step of the delay lines to write next
+    uint32 seed = 1; // state for the excitation noise
+    int idleSamples = 0; // samples rendered since all voices were damped
+    
+    // per-voice parameters, laid out for vector loads
+    int length[SYNTH_LANES]; // the delay length in samples
+    float samplesLeft[SYNTH_LANES]; // samples until the voice is damped
+    float feedback[SYNTH_LANES]; // the loop gain while ringing
+    float level[SYNTH_LANES]; // the output level
+
+  private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StringSynth)
+};
+
+#endif  // STRINGSYNTH_H_INCLUDED
@@ -0,0 +1,115 @@
+#include "Trace.h"
+
+#if STANGIN_TRACE
+
+// the most threads that can record markers, and markers held for each
+#define TRACE_THREADS 16
+#define TRACE_BUFFER_SIZE 16384
+
+// a queue of markers written by one thread and read by the exporter
+struct TraceBuffer {
+  TraceBuffer() : fifo(TRACE_BUFFER_SIZE) { }
+  AbstractFifo fifo;
+  TraceRecord records[TRACE_BUFFER_SIZE];
+};
+
+static TraceBuffer traceBuffers[TRACE_THREADS];
+// the number of buffers claimed by threads
+static Atomic<int> traceBuffersUsed;
+// the number of markers dropped because a buffer was full or none were left
+static Atomic<int> traceMarkersDropped;
+// the buffer for the calling thread
+static thread_local TraceBuffer *threadTraceBuffer = nullptr;
+
+// THREADS BEING TRACED *******************************************************
+
+void traceMarker(const char *name, char phase) {
+  int64 ticks = Time::getHighResolutionTicks();
+  // claim a buffer the first time a thread records a marker
+  TraceBuffer *buffer = threadTraceBuffer;
+  if (buffer == nullptr) {
+    int index = ++traceBuffersUsed - 1;
+    if (index >= TRACE_THREADS) {
+      --traceBuffersUsed;
+      ++traceMarkersDropped;
+      return;
+    }
+    buffer = threadTraceBuffer = &traceBuffers[index];
+  }
+  int start1, size1, start2, size2;
+  buffer->fifo.prepareToWrite(1, start1, size1, start2, size2);
+  if (size1 < 1) {
+    ++traceMarkersDropped;
+    return;
+  }
+  TraceRecord &record = buffer->records[start1];
+  record.name = name;
+  record.ticks = ticks;
+  record.phase = phase;
+  buffer->fifo.finishedWrite(1);
+}
+
+// EXPORTER *******************************************************************
+
+TraceExporter::TraceExporter() : Thread("stangin trace") {
+  file = File::getSpecialLocation(File::userApplicationDataDirectory)
+    .getChildFile("stangin").getChildFile(String::formatted("trace-%s.json", 
+      Time::getCurrentTime().formatted("%Y%m%d-%H%M%S").toRawUTF8()));
+  startThread(0);
+}
+
+TraceExporter::~TraceExporter() {
+  stopThread(1000);
+}
+
+void TraceExporter::run() {
+  while (! threadShouldExit()) {
+    wait(100);
+    flush();
+  }
+  flush();
+}
+
+// markers are written in the JSON array form of the trace event format, 
+//  which viewers accept without a closing bracket, so a trace from a 
+//  session that crashes can still be opened
+void TraceExporter::flush() {
+  int i, tid, start1, size1, start2, size2;
+  String text;
+  int threads = jmin(TRACE_THREADS, traceBuffersUsed.get());
+  for (tid = 0; tid < threads; tid++) {
+    TraceBuffer &buffer = traceBuffers[tid];
+    buffer.fifo.prepareToRead(TRACE_BUFFER_SIZE, start1, size1, start2, size2);
+    for (i = 0; i < size1 + size2; i++) {
+      const TraceRecord &record = 
+        buffer.records[(i < size1) ? start1 + i : start2 + (i - size1)];
+      text += String::formatted(
+        "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d},\n", 
+        record.name, record.phase, 
+        Time::highResolutionTicksToSeconds(record.ticks) * 1000000.0, tid);
+    }
+    buffer.fifo.finishedRead(size1 + size2);
+  }
+  int dropped = traceMarkersDropped.get();
+  if (dropped != droppedReported) {
+    text += String::formatted(
+      "{\"name\":\"dropped markers\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"args\":{\"count\":%d}},\n", 
+      Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks()) * 1000000.0, 
+      dropped);
+    droppedReported = dropped;
+  }
+  if (text.isEmpty()) return;
+  if (stream == nullptr) {
+    file.getParentDirectory().createDirectory();
+    stream = new FileOutputStream(file);
+    if (stream->failedToOpen()) {
+      stream = nullptr;
+      return;
+    }
+    stream->writeText("[\n", false, false);
+  }
+  stream->writeText(text, false, false);
+  stream->flush();
+}
+
+#endif  // STANGIN_TRACE
@@ -0,0 +1,67 @@
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED
+
+#include "JuceHeader.h"
+
+// Scoped markers that time stages of the processing pipeline. Building with 
+//  STANGIN_TRACE=1 records them to a lock-free buffer for each thread, and a 
+//  background thread writes them out as a Chrome/Perfetto trace. Otherwise 
+//  they compile to nothing.
+#ifndef STANGIN_TRACE
+  #define STANGIN_TRACE 0
+#endif
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#if STANGIN_TRACE
+  // time the enclosing scope under the given name (a string literal)
+  #define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+  #define TRACE_SCOPE(name)
+#endif
+
+#if STANGIN_TRACE
+
+// a begin or end marker
+typedef struct {
+  const char *name; // the name of the scope, which must be a string literal
+  int64 ticks; // the high resolution time of the marker
+  char phase; // 'B' for the beginning of a scope or 'E' for the end
+} TraceRecord;
+
+// record a marker on the calling thread
+void traceMarker(const char *name, char phase);
+
+class TraceScope {
+  public:
+    TraceScope(const char *scopeName) : name(scopeName) { traceMarker(name, 'B'); }
+    ~TraceScope() { traceMarker(name, 'E'); }
+  private:
+    const char *name;
+};
+
+// writes recorded markers to a trace file while any instance exists
+//  (use with SharedResourcePointer)
+class TraceExporter : public Thread {
+  public:
+    TraceExporter();
+    ~TraceExporter();
+    
+    void run() override;
+
+  protected:
+    File file;
+    ScopedPointer<FileOutputStream> stream;
+    int droppedReported = 0;
+    
+    // write all recorded markers to the file
+    void flush();
+
+  private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TraceExporter)
+};
+
+#endif  // STANGIN_TRACE
+
+#endif  // TRACE_H_INCLUDED
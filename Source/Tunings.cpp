@@ -0,0 +1,193 @@
+#include "Tunings.h"
+
+// BUILT-IN TUNINGS ***********************************************************
+
+constexpr BuiltinTuning builtinTunings[] = {
+  TUNING("Standard",      "E",  "A",  "D",  "G",  "B",  "E"),
+  TUNING("Dad-Gad",       "D",  "A",  "D",  "G",  "A",  "D"),
+  TUNING("Dad-Dad",       "D",  "A",  "D",  "D",  "A",  "D"),
+  TUNING_SEPARATOR,
+  TUNING("Open A",        "E",  "A",  "C#", "E",  "A",  "E"),
+  TUNING("Open B",        "B",  "F#", "B",  "F#", "B",  "D#"),
+  TUNING("Open C",        "C",  "G",  "C",  "G",  "C",  "E"),
+  TUNING("Open D",        "D",  "A",  "D",  "F#", "A",  "D"),
+  TUNING("Open E",        "E",  "B",  "E",  "G#", "B",  "E"),
+  TUNING("Open F",        "F",  "A",  "C",  "F",  "C",  "F"),
+  TUNING("Open G",        "D",  "G",  "D",  "G",  "B",  "D"),
+  TUNING_SEPARATOR,
+  TUNING("Cross-note A",  "E",  "A",  "E",  "A",  "C",  "E"),
+  TUNING("Cross-note C",  "C",  "G",  "C",  "G",  "C",  "E"),
+  TUNING("Cross-note D",  "D",  "A",  "D",  "F",  "A",  "D"),
+  TUNING("Cross-note E",  "E",  "B",  "E",  "G",  "B",  "E"),
+  TUNING("Cross-note G",  "D",  "G",  "D",  "G",  "Bb", "D"),
+  TUNING_SEPARATOR,
+  TUNING("Major Thirds",  "E",  "G#", "C",  "E",  "G#", "C"),
+  TUNING("All Fourths",   "E",  "A",  "D",  "G",  "C",  "F"),
+  TUNING("Aug Fourths",   "C",  "F#", "C",  "F#", "C",  "F#"),
+  TUNING("All Fifths",    "C",  "G",  "D",  "A",  "E",  "G"),
+  TUNING_SEPARATOR,
+  TUNING("Drop D",        "D",  "A",  "D",  "G",  "B",  "E"),
+  TUNING("Double Drop D", "D",  "A",  "D",  "G",  "B",  "D")
+};
+
+// standard tuning must match the notes the controller reports for open strings
+static_assert((builtinTunings[0].tuning.string[0] == 0x40) && 
+              (builtinTunings[0].tuning.string[5] == 0x28), 
+              "standard tuning should run from E2 to E4");
+
+const int builtinTuningCount = sizeof(builtinTunings) / sizeof(BuiltinTuning);
+
+// TUNING LIBRARY *************************************************************
+
+// identifies the binary cache of the user's tuning file
+#define TUNING_CACHE_MAGIC 0x4E555453 // "STUN"
+#define TUNING_CACHE_VERSION 1
+
+TuningLibrary::TuningLibrary() {
+  int i;
+  for (i = 0; i < builtinTuningCount; i++) {
+    const BuiltinTuning &builtin = builtinTunings[i];
+    if (builtin.label == nullptr) {
+      menu.addSeparator();
+      continue;
+    }
+    tunings.add(builtin.tuning);
+    menu.addItem(tunings.size(), String(builtin.label));
+  }
+  loadUserTunings();
+  if ((userTunings.size() > 0) || (errors.size() > 0)) menu.addSeparator();
+  for (i = 0; i < userTunings.size(); i++) {
+    tunings.add(userTunings[i]);
+    menu.addItem(tunings.size(), userLabels[i]);
+  }
+  for (i = 0; i < errors.size(); i++) {
+    menu.addItem(-1, errors[i], false);
+  }
+}
+
+File TuningLibrary::getUserFile() {
+  return(File::getSpecialLocation(File::userApplicationDataDirectory)
+           .getChildFile("stangin").getChildFile("tunings.txt"));
+}
+
+// load user tunings from the binary cache if it's up to date, otherwise 
+//  parse them from the text file and update the cache
+void TuningLibrary::loadUserTunings() {
+  File source = getUserFile();
+  if (! source.existsAsFile()) return;
+  File cache = source.withFileExtension("cache");
+  if (readCache(cache, source)) return;
+  parseUserFile(source);
+  if (errors.size() == 0) writeCache(cache, source);
+}
+
+// the cache holds the size and modification time of the file it was made 
+//  from, followed by a count of tunings and for each the six open notes and 
+//  a length-prefixed UTF-8 label
+bool TuningLibrary::readCache(const File &cache, const File &source) {
+  FileInputStream stream(cache);
+  if (stream.failedToOpen()) return(false);
+  if ((stream.readInt() != TUNING_CACHE_MAGIC) || 
+      (stream.readInt() != TUNING_CACHE_VERSION) ||
+      (stream.readInt64() != source.getSize()) ||
+      (stream.readInt64() != source.getLastModificationTime().toMilliseconds())) {
+    return(false);
+  }
+  int count = stream.readInt();
+  if ((count < 0) || (count > 1024)) return(false);
+  for (int i = 0; i < count; i++) {
+    Tuning tuning;
+    char label[256];
+    if (stream.read(tuning.string, 6) != 6) break;
+    int length = stream.readByte() & 0xFF;
+    if (stream.read(label, length) != length) break;
+    userTunings.add(tuning);
+    userLabels.add(String::fromUTF8(label, length));
+  }
+  if (userTunings.size() == count) return(true);
+  userTunings.clear();
+  userLabels.clear();
+  return(false);
+}
+
+void TuningLibrary::writeCache(const File &cache, const File &source) {
+  cache.deleteFile();
+  FileOutputStream stream(cache);
+  if (stream.failedToOpen()) return;
+  stream.writeInt(TUNING_CACHE_MAGIC);
+  stream.writeInt(TUNING_CACHE_VERSION);
+  stream.writeInt64(source.getSize());
+  stream.writeInt64(source.getLastModificationTime().toMilliseconds());
+  stream.writeInt(userTunings.size());
+  for (int i = 0; i < userTunings.size(); i++) {
+    stream.write(userTunings[i].string, 6);
+    const char *label = userLabels[i].toRawUTF8();
+    int length = jmin(255, (int)strlen(label));
+    stream.writeByte((char)length);
+    stream.write(label, length);
+  }
+}
+
+// read lines like "Name: E A D G B E" or "Name: B1 E2 A2 D3 G3 B3 E4", 
+//  with notes listed from the lowest string up
+void TuningLibrary::parseUserFile(const File &source) {
+  StringArray lines;
+  source.readLines(lines);
+  for (int i = 0; i < lines.size(); i++) {
+    String line = lines[i].upToFirstOccurrenceOf("#", false, false).trim();
+    if (line.isEmpty()) continue;
+    String name = line.upToFirstOccurrenceOf(":", false, false).trim();
+    String notes = line.fromFirstOccurrenceOf(":", false, false).trim();
+    Tuning tuning;
+    String label;
+    if ((! line.containsChar(':')) || (name.isEmpty()) || 
+        (! parseTuning(notes, tuning, label))) {
+      errors.add(String::formatted("%s line %d: can't read \"%s\"", 
+        source.getFileName().toRawUTF8(), i + 1, line.toRawUTF8()));
+      continue;
+    }
+    userTunings.add(tuning);
+    userLabels.add(label + " (" + name + ")");
+  }
+}
+
+// parse a list of 4 to 8 notes, lowest first, into a tuning for the six 
+//  strings of the controller; notes with an octave number are absolute 
+//  (C4 is middle C), and others are the next note above the one before 
+//  (notes can be separated by dashes, so octaves can't be negative)
+bool TuningLibrary::parseTuning(const String &notes, Tuning &tuning, String &label) {
+  StringArray tokens;
+  tokens.addTokens(notes, " \t,-", "");
+  tokens.removeEmptyStrings();
+  if ((tokens.size() < 4) || (tokens.size() > 8)) return(false);
+  int note = 35;
+  int layout[8];
+  for (int i = 0; i < tokens.size(); i++) {
+    String token = tokens[i];
+    int pitch = letterPitchClass((char)token[0]);
+    if (pitch < 0) return(false);
+    int next = 1;
+    if (token[1] == '#') { pitch += 1; next++; }
+    else if (token[1] == 'b') { pitch -= 1; next++; }
+    pitch = (pitch + 12) % 12;
+    String octave = token.substring(next);
+    if (octave.isEmpty()) {
+      note = nextNote(note, pitch);
+    }
+    else if (octave.containsOnly("0123456789")) {
+      note = ((octave.getIntValue() + 1) * 12) + pitch;
+    }
+    else return(false);
+    if ((note < 0) || (note > 127)) return(false);
+    layout[i] = note;
+  }
+  // play the lowest six strings of longer layouts, and extend shorter 
+  //  layouts upward in fourths
+  for (int i = 0; i < 6; i++) {
+    note = (i < tokens.size()) ? layout[i] : tuning.string[6 - i] + 5;
+    if (note > 127) return(false);
+    tuning.string[5 - i] = (uint8_t)note;
+  }
+  label = tokens.joinIntoString("-");
+  return(true);
+}
@@ -0,0 +1,101 @@
+#ifndef TUNINGS_H_INCLUDED
+#define TUNINGS_H_INCLUDED
+
+#include "JuceHeader.h"
+
+// open notes for the six strings of the controller
+typedef struct {
+  uint8_t string[6]; // string 0 has the highest pitch
+} Tuning;
+
+// a built-in tuning, computed at compile time
+typedef struct {
+  const char *label; // the label for the tuning menu, or nullptr for a separator
+  Tuning tuning;
+} BuiltinTuning;
+
+// COMPILE-TIME HELPERS *******************************************************
+
+// get the pitch class of a note letter, or -1 if it isn't one
+constexpr int letterPitchClass(char c) {
+  return(((c == 'C') || (c == 'c')) ? 0 : ((c == 'D') || (c == 'd')) ? 2 :
+         ((c == 'E') || (c == 'e')) ? 4 : ((c == 'F') || (c == 'f')) ? 5 :
+         ((c == 'G') || (c == 'g')) ? 7 : ((c == 'A') || (c == 'a')) ? 9 :
+         ((c == 'B') || (c == 'b')) ? 11 : -1);
+}
+// get the pitch class of a note name like "C", "C#" or "Db"
+constexpr int pitchClass(const char *name) {
+  return((letterPitchClass(name[0]) + 12 + 
+          ((name[1] == '#') ? 1 : (name[1] == 'b') ? -1 : 0)) % 12);
+}
+// get the lowest note at or above the given note with the given pitch class
+constexpr uint8_t nextNote(int note, int pitchClass) {
+  return((uint8_t)(note + ((pitchClass - (note % 12) + 12) % 12)));
+}
+
+// build a tuning from pitch classes, lowest string first, with each string 
+//  the next note of its pitch class above the one below it
+constexpr BuiltinTuning tuningFrom5(const char *label, uint8_t n5, uint8_t n4, 
+    uint8_t n3, uint8_t n2, uint8_t n1, const char *s0) {
+  return(BuiltinTuning{ label, { { nextNote(n1, pitchClass(s0)), n1, n2, n3, n4, n5 } } });
+}
+constexpr BuiltinTuning tuningFrom4(const char *label, uint8_t n5, uint8_t n4, 
+    uint8_t n3, uint8_t n2, const char *s1, const char *s0) {
+  return(tuningFrom5(label, n5, n4, n3, n2, nextNote(n2, pitchClass(s1)), s0));
+}
+constexpr BuiltinTuning tuningFrom3(const char *label, uint8_t n5, uint8_t n4, 
+    uint8_t n3, const char *s2, const char *s1, const char *s0) {
+  return(tuningFrom4(label, n5, n4, n3, nextNote(n3, pitchClass(s2)), s1, s0));
+}
+constexpr BuiltinTuning tuningFrom2(const char *label, uint8_t n5, uint8_t n4, 
+    const char *s3, const char *s2, const char *s1, const char *s0) {
+  return(tuningFrom3(label, n5, n4, nextNote(n4, pitchClass(s3)), s2, s1, s0));
+}
+constexpr BuiltinTuning tuningFrom1(const char *label, uint8_t n5, 
+    const char *s4, const char *s3, const char *s2, const char *s1, const char *s0) {
+  return(tuningFrom2(label, n5, nextNote(n5, pitchClass(s4)), s3, s2, s1, s0));
+}
+// the lowest string starts from the B below low E
+#define TUNING(name, s5, s4, s3, s2, s1, s0) \
+  tuningFrom1(s5 "-" s4 "-" s3 "-" s2 "-" s1 "-" s0 " (" name ")", \
+              nextNote(35, pitchClass(s5)), s4, s3, s2, s1, s0)
+#define TUNING_SEPARATOR BuiltinTuning{ nullptr, { { 0, 0, 0, 0, 0, 0 } } }
+
+// the built-in tunings, in menu order
+extern const BuiltinTuning builtinTunings[];
+extern const int builtinTuningCount;
+
+// TUNING LIBRARY *************************************************************
+
+// the built-in tunings plus any from the user's tuning file, loaded once and 
+//  shared by all editors (use with SharedResourcePointer)
+class TuningLibrary {
+  public:
+    TuningLibrary();
+    
+    // tunings by menu item ID - 1
+    Array<Tuning> tunings;
+    // a menu of all tunings
+    PopupMenu menu;
+    
+    // get the user's tuning file
+    static File getUserFile();
+
+  protected:
+    // user tunings and their labels
+    Array<Tuning> userTunings;
+    StringArray userLabels;
+    // problems found in the user's tuning file
+    StringArray errors;
+    
+    void loadUserTunings();
+    bool readCache(const File &cache, const File &source);
+    void writeCache(const File &cache, const File &source);
+    void parseUserFile(const File &source);
+    bool parseTuning(const String &notes, Tuning &tuning, String &label);
+
+  private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TuningLibrary)
+};
+
+#endif  // TUNINGS_H_INCLUDED
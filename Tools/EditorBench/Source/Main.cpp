@@ -0,0 +1,212 @@
+// Measures how long the editor takes to draw, by rendering it into an 
+//  offscreen image with the software renderer. For each state fixture and 
+//  editor size it reports the time and heap allocations per frame for a 
+//  whole paint and for each kind of element drawn.
+//
+// Usage:
+//   EditorBench [frames]   (the default is 200 frames per measurement)
+
+#include "JuceHeader.h"
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/PluginEditor.h"
+
+#include <atomic>
+
+// ALLOCATION COUNTING ********************************************************
+
+static std::atomic<int64> allocations(0);
+
+// count every heap allocation by wrapping the C library's allocator, which 
+//  operator new uses and JUCE's HeapBlock, Array, Path and Image storage 
+//  call directly (this relies on glibc, as the project only builds on Linux)
+extern "C" {
+  void *__libc_malloc(size_t size);
+  void *__libc_calloc(size_t count, size_t size);
+  void *__libc_realloc(void *p, size_t size);
+  
+  void *malloc(size_t size) {
+    allocations++;
+    return(__libc_malloc(size));
+  }
+  void *calloc(size_t count, size_t size) {
+    allocations++;
+    return(__libc_calloc(count, size));
+  }
+  void *realloc(void *p, size_t size) {
+    allocations++;
+    return(__libc_realloc(p, size));
+  }
+}
+
+// FIXTURES *******************************************************************
+
+// the time between editor frames, in samples
+#define FRAME_SAMPLES (44100 / 20)
+
+// a processor that lets fixtures feed the tablature
+class BenchProcessor : public StanginAudioProcessor {
+  public:
+    void addTabEvent(int string, int fret, uint8_t velocity, int64 time) {
+      writeTabEvent(string, fret, velocity, time);
+    }
+};
+
+// an editor that can be resized and have its tablature advanced directly
+class BenchEditor : public StanginAudioProcessorEditor {
+  public:
+    BenchEditor(StanginAudioProcessor &p) : StanginAudioProcessorEditor(p) {
+      // frames are drawn by the benchmark, not the timer
+      stopTimer();
+    }
+    
+    // lay out the editor for a different font size
+    void setEm(int newEm) {
+      em = newEm;
+      font = font.withHeight((float)em);
+      smallFont = font.withHeight((float)((em * 2) / 3));
+      setSize(21 * em, 35 * em);
+    }
+    
+    void advanceTablature() { updateTablature(); }
+};
+
+typedef enum {
+  FixtureIdle, // the state after a reset, with no strings sounding
+  FixtureChords, // all strings sounding at mixed frets
+  FixtureBusy, // fast playing with every setting changed from its default
+  FixtureCount
+} Fixture;
+
+static const char *fixtureNames[FixtureCount] = { "idle", "chords", "busy" };
+
+// the number of frames drawn so far, which keeps the timeline moving forward 
+//  across measurements so the tablature always scrolls
+static int64 frameClock = 0;
+
+// set up the processor state for the next frame of a fixture
+static void applyFixture(BenchProcessor &processor, GuitarState base, Fixture fixture) {
+  int i;
+  int64 frame = frameClock++;
+  int64 time = frame * FRAME_SAMPLES;
+  GuitarState state = base;
+  processor.samplePosition = time;
+  if (fixture != FixtureIdle) {
+    const int frets[6] = { 3, 2, 0, 0, 3, 3 };
+    for (i = 0; i < 6; i++) {
+      StringState &string = state.string[i];
+      string.fret = (fixture == FixtureBusy) ? (frets[i] + (int)(frame % 12)) : frets[i];
+      string.velocity = 100;
+      string.samplesSustain = 44100 * 2;
+      string.noteTime = time - (i * FRAME_SAMPLES);
+      string.endTime = string.noteTime + string.samplesSustain;
+      string.note = string.openNote + string.fret;
+    }
+  }
+  if (fixture == FixtureBusy) {
+    state.detune = -12;
+    state.sustain = 4.5;
+    state.hammeron = state.pulloff = state.dampOpen = state.tap = true;
+    state.passthrough = PassAll;
+    state.passthroughChannel = 7;
+    state.monitor = true;
+    state.polyphony = 4;
+    state.stealPolicy = StealQuietest;
+    state.reconcileWindow = 0.010;
+    state.velocityCurve = CurveUser;
+    for (i = 0; i < 128; i++) state.userCurve[i] = (uint8_t)(127 - i);
+    // strum every string each frame
+    for (i = 0; i < 6; i++) {
+      processor.addTabEvent(i, state.string[i].fret, (uint8_t)(64 + (i * 10)), 
+                            time - (i * 64));
+    }
+  }
+  processor.guitar = state;
+}
+
+// MEASUREMENT ****************************************************************
+
+typedef enum {
+  ElementFrame, // a whole frame, including the tablature update
+  ElementPaint, // paint alone
+  ElementStrings,
+  ElementSliders,
+  ElementButtons,
+  ElementTuningMenu,
+  ElementCurve,
+  ElementTablature, // scrolling and drawing new events into the tablature
+  ElementCount
+} Element;
+
+static const char *elementNames[ElementCount] = 
+  { "frame", "paint", "drawStrings", "drawSliders", "drawButtons", 
+    "drawTuningMenu", "drawCurve", "updateTablature" };
+
+static void drawElement(BenchEditor &editor, Graphics &g, Element element) {
+  switch (element) {
+    case ElementFrame: editor.advanceTablature(); editor.paint(g); break;
+    case ElementPaint: editor.paint(g); break;
+    case ElementStrings: editor.drawStrings(g); break;
+    case ElementSliders: editor.drawSliders(g); break;
+    case ElementButtons: editor.drawButtons(g); break;
+    case ElementTuningMenu: editor.drawTuningMenu(g); break;
+    case ElementCurve: editor.drawCurve(g); break;
+    case ElementTablature: editor.advanceTablature(); break;
+    default: break;
+  }
+}
+
+static void measure(BenchProcessor &processor, BenchEditor &editor, GuitarState base, 
+                    Fixture fixture, Element element, int frames) {
+  int frame;
+  Image image(Image::ARGB, editor.getWidth(), editor.getHeight(), true, 
+              SoftwareImageType());
+  Graphics g(image);
+  // warm up caches, and position the tuning menu, which drawStrings does
+  for (frame = 0; frame < 10; frame++) {
+    applyFixture(processor, base, fixture);
+    editor.paint(g);
+    editor.advanceTablature();
+  }
+  double seconds = 0.0;
+  int64 allocated = 0;
+  for (frame = 0; frame < frames; frame++) {
+    applyFixture(processor, base, fixture);
+    int64 startAllocations = allocations.load();
+    int64 start = Time::getHighResolutionTicks();
+    drawElement(editor, g, element);
+    seconds += Time::highResolutionTicksToSeconds(
+      Time::getHighResolutionTicks() - start);
+    allocated += allocations.load() - startAllocations;
+  }
+  // drain tablature events left by measurements that don't draw them
+  editor.advanceTablature();
+  printf("%-8s %4dx%-4d %-16s %10.1f %10.1f\n", 
+         fixtureNames[fixture], editor.getWidth(), editor.getHeight(), 
+         elementNames[element], (seconds * 1000000.0) / (double)frames, 
+         (double)allocated / (double)frames);
+}
+
+int main(int argc, char *argv[]) {
+  int frames = (argc > 1) ? atoi(argv[1]) : 200;
+  if (frames < 1) frames = 1;
+  ScopedJuceInitialiser_GUI juceInitialiser;
+  {
+    const int ems[] = { 12, 18, 27, 36 };
+    BenchProcessor processor;
+    processor.setPlayConfigDetails(0, 0, 44100.0, 512);
+    processor.prepareToPlay(44100.0, 512);
+    GuitarState base = processor.guitar;
+    BenchEditor editor(processor);
+    printf("%-8s %-9s %-16s %10s %10s\n", 
+           "fixture", "size", "element", "us/frame", "allocs");
+    for (int em : ems) {
+      editor.setEm(em);
+      for (int f = 0; f < FixtureCount; f++) {
+        for (int e = 0; e < ElementCount; e++) {
+          measure(processor, editor, base, (Fixture)f, (Element)e, frames);
+        }
+      }
+    }
+  }
+  return(0);
+}
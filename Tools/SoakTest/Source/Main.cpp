@@ -0,0 +1,284 @@
+// Plays days of simulated guitar through the processor as fast as it will go, 
+//  with long idle gaps, settings changes and the reconciliation window being 
+//  dragged while notes are held, and checks that the notes it 
+//  sends stay consistent: every note on is matched by a note off, and no note 
+//  is left sounding past the end of its string's sustain.
+//
+// Usage:
+//   SoakTest [days] [sampleRate] [seed]   (the default is 3 days at 192 kHz)
+
+#include "JuceHeader.h"
+#include "../../../Source/PluginProcessor.h"
+
+// the most failures to describe before only counting them
+#define MAX_REPORTED 20
+
+// SIMULATED CONTROLLER *******************************************************
+
+// the fret codes the controller sends for the open strings, highest first
+static const uint8_t openFretCodes[6] = { 0x40, 0x3B, 0x37, 0x32, 0x2D, 0x28 };
+
+// queue a controller sysex message with the given type and payload
+static void addSysex(MidiBuffer &input, int sample, uint8_t type, 
+                     uint8_t a, uint8_t b, uint8_t c = 0) {
+  uint8_t data[9] = { 0xF0, 0x08, 0x40, 0x0A, type, a, b, c, 0xF7 };
+  if (type == 0x08) input.addEvent(data, 9, sample);
+  else {
+    data[7] = 0xF7;
+    input.addEvent(data, 8, sample);
+  }
+}
+
+static void addFret(MidiBuffer &input, int sample, int string, int fret) {
+  addSysex(input, sample, 0x01, (uint8_t)(string + 1), 
+           (uint8_t)(openFretCodes[string] + fret));
+}
+
+static void addPick(MidiBuffer &input, int sample, int string, int velocity) {
+  addSysex(input, sample, 0x05, (uint8_t)(string + 1), (uint8_t)velocity);
+}
+
+// send the state of the buttons as three bytes, where the arrows are 0x08 
+//  when none is held
+static void addButtons(MidiBuffer &input, int sample, uint8_t a, uint8_t b, uint8_t c) {
+  addSysex(input, sample, 0x08, a, b, c);
+}
+
+// a player that alternates between bursts of playing and idle gaps
+class Player {
+  public:
+    Player(Random &r, double rate) : random(r), sampleRate(rate) { }
+    
+    bool playing = false;
+    int64 phaseEnd = 0; // the time the current phase ends
+    int64 nextEvent = 0; // the time of the next event while playing
+    uint8_t buttons[3] = { 0, 0, 0x08 }; // the buttons being held
+    
+    // add the events for a block starting at the given time
+    void play(MidiBuffer &input, int64 blockStart, int blockSize) {
+      while (nextEvent < blockStart + blockSize) {
+        if (nextEvent >= blockStart) {
+          addEvent(input, (int)(nextEvent - blockStart));
+        }
+        // players are mostly quick, sometimes slow
+        double gap = (random.nextInt(8) == 0) ? 
+          random.nextDouble() * 2.0 : random.nextDouble() * 0.2;
+        nextEvent += jmax((int64)1, (int64)(gap * sampleRate));
+      }
+    }
+    
+    // choose how long the next phase lasts, starting at the given time
+    void nextPhase(int64 time) {
+      playing = ! playing;
+      double seconds;
+      if (playing) seconds = 1.0 + (random.nextDouble() * 600.0);
+      // idle gaps run from a few seconds to a few hours
+      else seconds = pow(10.0, 0.5 + (random.nextDouble() * 3.6));
+      phaseEnd = time + (int64)(seconds * sampleRate);
+      nextEvent = time;
+    }
+
+  protected:
+    Random &random;
+    double sampleRate;
+    
+    void addEvent(MidiBuffer &input, int sample) {
+      int string = random.nextInt(6);
+      int kind = random.nextInt(100);
+      // strum chords
+      if (kind < 10) {
+        for (int i = 5; i >= 0; i--) {
+          addPick(input, sample, i, 1 + random.nextInt(127));
+        }
+      }
+      // pick, sometimes just ahead of the fret change it goes with, as the 
+      //  controller often does
+      else if (kind < 55) {
+        addPick(input, sample, string, 1 + random.nextInt(127));
+        if (random.nextBool()) addFret(input, sample, string, random.nextInt(23));
+      }
+      // change frets
+      else if (kind < 95) {
+        addFret(input, sample, string, random.nextInt(23));
+      }
+      // press or release a button
+      else {
+        int button = random.nextInt(12);
+        if (button < 4) buttons[0] ^= (uint8_t)(1 << button);
+        else if (button == 4) buttons[1] ^= 0x01; // select
+        else if (button == 5) buttons[1] ^= 0x02; // start
+        else if (button == 6) buttons[1] ^= 0x10; // console
+        else if (button == 7) buttons[2] ^= 0x40; // shake
+        else {
+          // the arrows share a value, so only one can be held
+          uint8_t arrow = (uint8_t)((button - 8) * 2);
+          buttons[2] = (buttons[2] & 0xF0) | 
+            (((buttons[2] & 0x0F) == arrow) ? 0x08 : arrow);
+        }
+        addButtons(input, sample, buttons[0], buttons[1], buttons[2]);
+      }
+    }
+};
+
+// CHECKING *******************************************************************
+
+class Checker {
+  public:
+    int sounding[6] = { -1, -1, -1, -1, -1, -1 }; // notes sent for each string
+    int64 notes = 0; // the number of notes started
+    int64 failures = 0;
+    
+    // check the messages sent in a block
+    void checkOutput(const MidiBuffer &output, int64 blockStart, int blockSize) {
+      MidiBuffer::Iterator i(output);
+      MidiMessage message;
+      int sample;
+      while (i.getNextEvent(message, sample)) {
+        int64 time = blockStart + sample;
+        if ((sample < 0) || (sample >= blockSize)) {
+          fail(time, "message at sample %d of a %d sample block", sample, blockSize);
+        }
+        int string = message.getChannel() - 1;
+        if ((string < 0) || (string >= 6)) continue;
+        if (message.isNoteOn()) {
+          if (sounding[string] >= 0) {
+            fail(time, "note on %d for string %d while %d is sounding", 
+                 message.getNoteNumber(), string + 1, sounding[string]);
+          }
+          sounding[string] = message.getNoteNumber();
+          notes++;
+        }
+        else if (message.isNoteOff()) {
+          if (sounding[string] != message.getNoteNumber()) {
+            fail(time, "note off %d for string %d while %d is sounding", 
+                 message.getNoteNumber(), string + 1, sounding[string]);
+          }
+          sounding[string] = -1;
+        }
+      }
+    }
+    
+    // check that notes still sounding at the end of a block should be
+    void checkStrings(const GuitarState &guitar, int64 blockEnd) {
+      for (int i = 0; i < 6; i++) {
+        const StringState &string = guitar.string[i];
+        if (sounding[i] != string.note) {
+          fail(blockEnd, "string %d sent note %d but the engine has %d", 
+               i + 1, sounding[i], string.note);
+        }
+        if ((sounding[i] >= 0) && (string.endTime < blockEnd)) {
+          fail(blockEnd, "string %d is still sounding %lld samples past its end", 
+               i + 1, (long long)(blockEnd - string.endTime));
+        }
+      }
+    }
+    
+    void fail(int64 time, const char *format, ...) {
+      if (failures++ >= MAX_REPORTED) return;
+      char text[256];
+      va_list args;
+      va_start(args, format);
+      vsnprintf(text, sizeof(text), format, args);
+      va_end(args);
+      printf("FAIL at sample %lld: %s\n", (long long)time, text);
+    }
+};
+
+// SIMULATION *****************************************************************
+
+// change the settings the way a user might from the editor
+static void changeSettings(Random &random, StanginAudioProcessor &processor) {
+  GuitarState &guitar = processor.guitar;
+  switch (random.nextInt(8)) {
+    case 0: guitar.hammeron = ! guitar.hammeron; break;
+    case 1: guitar.pulloff = ! guitar.pulloff; break;
+    case 2: guitar.dampOpen = ! guitar.dampOpen; break;
+    case 3: guitar.tap = ! guitar.tap; break;
+    case 4: guitar.polyphony = 1 + random.nextInt(6); break;
+    case 5: guitar.stealPolicy = random.nextInt(StealPolicyCount); break;
+    case 6: guitar.velocityCurve = random.nextInt(CurveCount); break;
+    case 7:
+      guitar.reconcileWindow = random.nextBool() ? 0.0 : 
+        random.nextDouble() * processor.maxReconcileWindow;
+      processor.updateLatency();
+      break;
+  }
+}
+
+// move the reconciliation window a millisecond, as each step of dragging its 
+//  slider does
+static void dragWindow(Random &random, StanginAudioProcessor &processor) {
+  GuitarState &guitar = processor.guitar;
+  double step = random.nextBool() ? 0.001 : -0.001;
+  guitar.reconcileWindow = jlimit(0.0, (double)processor.maxReconcileWindow, 
+                                  guitar.reconcileWindow + step);
+  processor.updateLatency();
+}
+
+int main(int argc, char *argv[]) {
+  double days = (argc > 1) ? atof(argv[1]) : 3.0;
+  double sampleRate = (argc > 2) ? atof(argv[2]) : 192000.0;
+  int64 seed = (argc > 3) ? atoll(argv[3]) : Time::currentTimeMillis();
+  if (sampleRate < 1.0) sampleRate = 192000.0;
+  ScopedJuceInitialiser_GUI juceInitialiser;
+  Random random(seed);
+  StanginAudioProcessor processor;
+  processor.setPlayConfigDetails(0, 0, sampleRate, 8192);
+  processor.prepareToPlay(sampleRate, 8192);
+  Player player(random, sampleRate);
+  Checker checker;
+  AudioSampleBuffer buffer(0, 8192);
+  MidiBuffer midi;
+  int64 end = (int64)(days * 86400.0 * sampleRate);
+  int64 time = 0;
+  int64 blocks = 0;
+  int64 startTicks = Time::getHighResolutionTicks();
+  printf("simulating %.2f days at %.0f Hz with seed %lld\n", 
+         days, sampleRate, (long long)seed);
+  while (time < end) {
+    if (time >= player.phaseEnd) {
+      player.nextPhase(time);
+      // change settings and switch between live and offline rendering 
+      //  now and then, as happens between takes
+      if (random.nextInt(4) == 0) changeSettings(random, processor);
+      if (random.nextInt(8) == 0) processor.setNonRealtime(! processor.isNonRealtime());
+    }
+    // hosts use smaller blocks while playing and any size while idle
+    int blockSize = player.playing ? 32 << random.nextInt(6) : 8192;
+    buffer.setSize(0, blockSize, false, false, true);
+    if ((player.playing) && (random.nextInt(64) == 0)) dragWindow(random, processor);
+    midi.clear();
+    if (player.playing) player.play(midi, time, blockSize);
+    processor.processBlock(buffer, midi);
+    checker.checkOutput(midi, time, blockSize);
+    time += blockSize;
+    checker.checkStrings(processor.guitar, time);
+    blocks++;
+  }
+  // release every button and press the console button to stop everything, 
+  //  then let the engine catch up using full size blocks so that messages 
+  //  held for the longest window are handled, after which nothing should 
+  //  be sounding
+  buffer.setSize(0, 8192, false, false, true);
+  midi.clear();
+  addButtons(midi, 0, 0, 0, 0x08);
+  addButtons(midi, 1, 0, 0x10, 0x08);
+  for (int i = 0; i < 4; i++) {
+    processor.processBlock(buffer, midi);
+    checker.checkOutput(midi, time, buffer.getNumSamples());
+    time += buffer.getNumSamples();
+    checker.checkStrings(processor.guitar, time);
+    midi.clear();
+  }
+  for (int i = 0; i < 6; i++) {
+    if (checker.sounding[i] >= 0) {
+      checker.fail(time, "string %d never stopped note %d", i + 1, checker.sounding[i]);
+    }
+  }
+  double seconds = Time::highResolutionTicksToSeconds(
+    Time::getHighResolutionTicks() - startTicks);
+  printf("%lld blocks, %lld notes, %lld failures in %.1f seconds (%.0fx realtime)\n", 
+         (long long)blocks, (long long)checker.notes, (long long)checker.failures, 
+         seconds, ((double)time / sampleRate) / jmax(seconds, 0.001));
+  return((checker.failures > 0) ? 1 : 0);
+}
@@ -0,0 +1,96 @@
+// A reference reader for the shared memory segment published by Stangin.
+//
+// Build with:
+//   g++ -std=c++11 -O2 -I../Source -o stangin-reader stangin-reader.cpp -lrt
+//
+// Usage:
+//   stangin-reader [segment]   (the default segment is /stangin-0)
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "SharedStateLayout.h"
+
+static const char *noteNames[12] = 
+  { "C", "C#", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B" };
+
+// copy a consistent snapshot of the segment, along with any events newer 
+//  than lastEventCount
+static void readSnapshot(const SharedGuitarState *shared, SharedGuitarState *copy, 
+                         uint64_t lastEventCount) {
+  uint32_t s1, s2;
+  do {
+    s1 = shared->sequence.load(std::memory_order_acquire);
+    copy->sampleRate = shared->sampleRate;
+    copy->samplePosition = shared->samplePosition;
+    copy->detune = shared->detune;
+    copy->sustain = shared->sustain;
+    copy->stolenVoices = shared->stolenVoices;
+    memcpy(copy->string, shared->string, sizeof(copy->string));
+    copy->eventCount = shared->eventCount;
+    for (uint64_t n = lastEventCount; n < copy->eventCount; n++) {
+      copy->event[n % STANGIN_SHM_EVENTS] = shared->event[n % STANGIN_SHM_EVENTS];
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    s2 = shared->sequence.load(std::memory_order_relaxed);
+  } while ((s1 & 1) || (s1 != s2));
+}
+
+int main(int argc, char **argv) {
+  const char *name = (argc > 1) ? argv[1] : STANGIN_SHM_PREFIX "0";
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) {
+    fprintf(stderr, "can't open %s (is the plugin running?)\n", name);
+    return(1);
+  }
+  void *mapped = mmap(NULL, sizeof(SharedGuitarState), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    fprintf(stderr, "can't map %s\n", name);
+    return(1);
+  }
+  const SharedGuitarState *shared = (const SharedGuitarState *)mapped;
+  if ((shared->magic != STANGIN_SHM_MAGIC) || 
+      (shared->version != STANGIN_SHM_VERSION) || 
+      (shared->size != sizeof(SharedGuitarState))) {
+    fprintf(stderr, "%s has an unexpected layout\n", name);
+    return(1);
+  }
+  static SharedGuitarState copy;
+  readSnapshot(shared, &copy, 0);
+  uint64_t lastEventCount = copy.eventCount;
+  while (true) {
+    readSnapshot(shared, &copy, lastEventCount);
+    // print new events, noting any that were overwritten before we read them
+    if (copy.eventCount - lastEventCount > STANGIN_SHM_EVENTS) {
+      printf("(missed %llu events)\n", (unsigned long long)
+        (copy.eventCount - lastEventCount - STANGIN_SHM_EVENTS));
+      lastEventCount = copy.eventCount - STANGIN_SHM_EVENTS;
+    }
+    for (; lastEventCount < copy.eventCount; lastEventCount++) {
+      const SharedEvent &event = copy.event[lastEventCount % STANGIN_SHM_EVENTS];
+      printf("\033[K%12lld  string %d  fret %2d  velocity %3d\n", 
+        (long long)event.time, event.string + 1, event.fret, event.velocity);
+    }
+    // print the state of the strings
+    printf("%12lld ", (long long)copy.samplePosition);
+    for (int i = 5; i >= 0; i--) {
+      const SharedString &string = copy.string[i];
+      if (string.note >= 0) {
+        printf(" %2s%-2d%c", noteNames[string.note % 12], string.fret, 
+               string.samplesLeft > 0 ? '*' : ' ');
+      }
+      else {
+        printf("   %-2d ", string.fret);
+      }
+    }
+    printf("  detune %+d  sustain %.1f  stolen %u\r", 
+           copy.detune, copy.sustain, copy.stolenVoices);
+    fflush(stdout);
+    usleep(50000);
+  }
+  return(0);
+}